@@ -0,0 +1,69 @@
+#pragma once
+
+#include "stdint.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h> // Variadic functions
+
+namespace Game {
+
+/* String with a fixed capacity inside the object (on the stack, no heap allocation),
+ * text which doesn't fit is cut off.
+ */
+template <size_t Capacity>
+class FixedString {
+
+    public:
+
+        static const size_t capacity = Capacity;
+
+    protected:
+
+        size_t length_;
+        char buffer[Capacity + 1];
+
+    public:
+
+        FixedString(): length_(0) { this->buffer[0] = '\0'; }
+        FixedString(const char* text): length_(0) { this->buffer[0] = '\0'; this->append(text); }
+
+        const char* c_str() const { return this->buffer; }
+        size_t length() const { return this->length_; }
+        bool empty() const { return this->length_ == 0; }
+        void clear() { this->length_ = 0; this->buffer[0] = '\0'; }
+
+        FixedString& append(const char* text) {
+            const size_t count = strnlen(text, Capacity - this->length_);
+            memcpy(this->buffer + this->length_, text, count);
+            this->length_ += count;
+            this->buffer[this->length_] = '\0';
+            return *this;
+        }
+
+        FixedString& vappendf(const char* format, va_list args) {
+            const int written = vsnprintf(this->buffer + this->length_, Capacity + 1 - this->length_, format, args);
+            if (written > 0) { this->length_ += ((size_t) written < Capacity - this->length_) ? (size_t) written : (Capacity - this->length_); }
+            return *this;
+        }
+
+        __attribute__((format(printf, 2, 3))) FixedString& appendf(const char* format, ...) {
+            va_list args;
+            va_start(args, format);
+            this->vappendf(format, args);
+            va_end(args);
+            return *this;
+        }
+
+        bool operator==(const char* text) const { return strcmp(this->buffer, text) == 0; }
+        bool operator!=(const char* text) const { return !(*this == text); }
+};
+
+// printf into a FixedString (instead of a heap allocated std::string)
+template <size_t Capacity = 32, typename... Args>
+FixedString<Capacity> format_str(const char* format, Args... args) {
+    FixedString<Capacity> text;
+    text.appendf(format, args...);
+    return text;
+}
+
+}; // namespace Game
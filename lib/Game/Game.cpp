@@ -1,6 +1,7 @@
 #include <Arduino.h>
 
 #include "Game.h"
+#include "Stick.h"
 #include "freertos/task.h"
 #include <PS4Controller.h>
 
@@ -16,44 +17,27 @@ const Direction Direction::UpLeft(-1, -1);
 const Direction Direction::DownLeft(-1, 1);
 const Direction Direction::DownRight(1, 1);
 const Direction Direction::None(0, 0);
+constexpr const char* Direction::names[9];
 
 
+// direction of the sticks in the last call (for the hysteresis of the octant table)
+static AnalogStick left_analog_stick;
+static AnalogStick right_analog_stick;
+
 Direction get_direction_from_ps4_control_pad() {
 
     if (PS4.isConnected()) {
 
-        if (PS4.data.button.up) { // up
-            Serial.println("Up Button");
-            return Direction::Up;
-        }
-        else if (PS4.data.button.down) { // down
-            Serial.println("Down Button");
-            return Direction::Down;
-        }
-        else if (PS4.data.button.left) { // left
-            Serial.println("Left Button");
-            return Direction::Left;
-        }
-        else if (PS4.data.button.right) { // right
-            Serial.println("Right Button");
-            return Direction::Right;
-        }
-        else if (PS4.data.button.upright) { // upright
-            Serial.println("Up Right Button");
-            return Direction::UpRight;
-        }
-        else if (PS4.data.button.upleft) { // upleft
-            Serial.println("Up Left Button");
-            return Direction::UpLeft;
-        }
-        else if (PS4.data.button.downleft) { // downleft
-            Serial.println("Down Left Button");
-            return Direction::DownLeft;
-        }
-        else if (PS4.data.button.downright) { // downright
-            Serial.println("Down Right Button");
-            return Direction::DownRight;
-        }
+        const ps4_button_t button = PS4.state().button;
+
+        if (button.up) { return Direction::Up; }
+        else if (button.down) { return Direction::Down; }
+        else if (button.left) { return Direction::Left; }
+        else if (button.right) { return Direction::Right; }
+        else if (button.upright) { return Direction::UpRight; }
+        else if (button.upleft) { return Direction::UpLeft; }
+        else if (button.downleft) { return Direction::DownLeft; }
+        else if (button.downright) { return Direction::DownRight; }
     }
     // else
     return Direction::None;
@@ -61,65 +45,25 @@ Direction get_direction_from_ps4_control_pad() {
 
 Direction get_direction_from_ps4_analog_stick(const bool left_stick, const uint32_t magnitude_thershold) {
 
-    if (PS4.isConnected()) {
+    AnalogStick& analog_stick = (left_stick ? left_analog_stick : right_analog_stick);
 
-        // const bool movement = ( \
-        //     PS4.event.analog_move.stick.lx || PS4.event.analog_move.stick.ly || \
-        //     PS4.event.analog_move.stick.rx || PS4.event.analog_move.stick.ry \
-        // );
+    if (PS4.isConnected()) {
 
         // Get analog values from analog stick
-        const int32_t analog_x = (left_stick ? PS4.data.analog.stick.lx :  PS4.data.analog.stick.rx);
-        const int32_t analog_y = (left_stick ? PS4.data.analog.stick.ly :  PS4.data.analog.stick.ry);
-
-        // Compare magnitude
-        const int32_t magnitude_squared = ((analog_x*analog_x) + (analog_y*analog_y));
-        if (magnitude_thershold*magnitude_thershold > magnitude_squared) {
-            return Direction::None;
-        }
-
-    
-        #define comp(value) (((value)*(16777216L))/(40503782L))
-
-        if (analog_y > 0 && abs(analog_x) <= comp(analog_y)) { // up
-            Serial.println("Stick Up");
-            return Direction::Up;
-        }
-        else if (analog_y < 0 && abs(analog_x) <= comp(-analog_y)) { // down
-            Serial.println("Stick Down");
-            return Direction::Down;
-        }
-        else if (analog_x < 0 && abs(analog_y) <= comp(-analog_x)) { // left
-            Serial.println("Left Button");
-            return Direction::Left;
-        }
-        else if (analog_x > 0 && abs(analog_y) <= comp(analog_x)) { // right
-            Serial.println("Stick Right");
-            return Direction::Right;
-        }
-        else if (analog_y > comp(analog_x) && analog_x > comp(analog_y)) { // upright
-            Serial.println("Stick Up Right");
-            return Direction::UpRight;
-        }
-        else if (analog_y > comp(-analog_x) && (-analog_x) > comp(analog_y)) { // upleft
-            Serial.println("Stick Up Left");
-            return Direction::UpLeft;
-        }
-        else if (analog_y < comp(analog_x) && analog_x < comp(analog_y)) { // downleft
-            Serial.println("Stick Down Left");
-            return Direction::DownLeft;
-        }
-        else if (analog_x > comp(-analog_y) && (-analog_y) > comp(analog_x)) { // downright
-            Serial.println("Stick Down Right");
-            return Direction::DownRight;
-        }
+        const ps4_analog_stick_t stick = PS4.state().analog.stick;
+        const int32_t analog_x = (left_stick ? stick.lx :  stick.rx);
+        const int32_t analog_y = (left_stick ? stick.ly :  stick.ry);
+
+        return analog_stick.update(analog_x, analog_y, magnitude_thershold);
     }
     // else
+    analog_stick.reset();
     return Direction::None;
 }
 
 Direction get_direction_from_ps4() {
-    return get_direction_from_ps4_control_pad() + get_direction_from_ps4_analog_stick(true, 100);
+    // control pad and stick pressed at the same time add up, e.g. (0, -2)
+    return (get_direction_from_ps4_control_pad() + get_direction_from_ps4_analog_stick(true, 100)).normalize();
 }
 
 
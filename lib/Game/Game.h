@@ -1,29 +1,38 @@
 #pragma once
 
 #include "stdint.h"
+#include <assert.h>
 #include <string>
 #include <utility>
 #include <set>
-#include <stdarg.h> // Variadic functions
 #include "FastLED.h" // Color
+#include "FixedString.h"
 
 namespace Game {
 
-template <typename... Args>
-std::string format_str(const std::string fmt, Args... args) {
+// Small and fast pseudo random number generator (xorshift32), so every game can use its own seed
+class Random {
 
-    char* buf = nullptr; 
-    const int res = asprintf(&buf, fmt.c_str(), args...);
+    public:
+
+        uint32_t state;
+
+        Random(const uint32_t seed = 1): state(seed != 0 ? seed : 0x9E3779B9) {}
 
-    if (res >= 0) {
-        const std::string temp(buf); 
-        free(buf); 
-        return temp; 
-    } 
-    else { 
-        return ""; 
-    }
-}
+        uint32_t next() {
+            uint32_t x = this->state;
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            this->state = x;
+            return x;
+        }
+
+        // random number in [0, max)
+        int32_t operator()(const int32_t max) {
+            return (max > 0) ? (int32_t)(((uint64_t)this->next() * (uint32_t)max) >> 32) : 0;
+        }
+};
 
 class Direction {
 
@@ -80,17 +89,18 @@ class Direction {
             return *this;
         }
 
-        std::string to_string() const {
-            if (*this == Up) { return "Up"; }
-            else if (*this == Down) { return "Down"; }
-            else if (*this == Left) { return "Left"; }
-            else if (*this == Right) { return "Right"; }
-            else if (*this == UpRight) { return "UpRight"; }
-            else if (*this == UpLeft) { return "UpLeft"; }
-            else if (*this == DownLeft) { return "DownLeft"; }
-            else if (*this == DownRight) { return "DownRight"; }
-            else if (*this == None) { return "None"; }
-            else { return format_str("(%d/%d)", this->x, this->y); }
+        // Names of the directions with x and y in [-1, 1], index (y + 1) * 3 + (x + 1)
+        static constexpr const char* names[9] = { "UpLeft", "Up", "UpRight", "Left", "None", "Right", "DownLeft", "Down", "DownRight" };
+
+        // Name of the direction, nullptr if it isn't one of the 8 directions or None
+        const char* name() const {
+            const bool unit = (this->x >= -1 && this->x <= 1 && this->y >= -1 && this->y <= 1);
+            return unit ? names[((this->y + 1) * 3) + (this->x + 1)] : nullptr;
+        }
+
+        FixedString<32> to_string() const {
+            const char* dir_name = this->name();
+            return (dir_name != nullptr) ? FixedString<32>(dir_name) : format_str("(%d/%d)", this->x, this->y);
         }
 
 
@@ -195,11 +205,143 @@ class Position {
         }
 
 
-        std::string to_string() const { return format_str("(%d/%d)", this->x, this->y); }
+        FixedString<32> to_string() const { return format_str("(%d/%d)", this->x, this->y); }
+
+
+    public:
+
+};
+
+// Position packed into a 16 bit cell index (x + y * width), a quarter of the size of a Position
+class Cell {
+
+    public:
+
+        static const uint16_t None = 0xFFFF; // no cell (e.g. outside of the gameboard)
+
+        uint16_t index;
+
+        Cell(const uint16_t Index = None): index(Index) {}
+
+        bool operator==(const Cell& other) const { return this->index == other.index; }
+        bool operator!=(const Cell& other) const { return this->index != other.index; }
+
+        bool valid() const { return this->index != None; }
+};
+
+/* Neighbour of every cell in the 8 directions, looping around or Cell::None at the edges of the gameboard
+ * (like game_tick()), and the position of every cell, so a move or converting a Cell to a Position is a single table
+ * lookup. The entries live in a NeighbourStorage, which is allocated once (static or at boot) for the biggest gameboard,
+ * the table only points to them: copying the table or a GameBoard which uses it doesn't allocate memory.
+ * 19 bytes per cell, for gameboards up to 256 cells wide and high with less than 65535 cells.
+ */
+class NeighbourTable {
+
+    public:
+
+        static const int32_t directions = 8;
+
+        // axes the head looped around on in a move (same bits as Tick_Loop_X and Tick_Loop_Y)
+        enum Wrap : uint32_t { Wrap_None = 0, Wrap_X = 1 << 0, Wrap_Y = 1 << 1 };
+
+    protected:
+
+        uint16_t* next_cells; // directions entries per cell
+        uint8_t* edges; // per cell, bit 0: left, 1: right, 2: top, 3: bottom edge
+        uint8_t* xs; // position of every cell
+        uint8_t* ys;
+        int32_t capacity; // cells
+        int32_t width;
+        int32_t height;
+        bool loop_x;
+        bool loop_y;
+
+        NeighbourTable(uint16_t* Next_cells, uint8_t* Edges, uint8_t* Xs, uint8_t* Ys, const int32_t Capacity):
+            next_cells(Next_cells), edges(Edges), xs(Xs), ys(Ys), capacity(Capacity), width(0), height(0), loop_x(false), loop_y(false) {}
+
+    public:
+
+        // index of a normalized direction other than None: (y + 1) * 3 + (x + 1) without None in the middle
+        static int32_t direction_index(const int32_t dx, const int32_t dy) {
+            const int32_t index = ((dy + 1) * 3) + (dx + 1);
+            return index - (index > 4);
+        }
+
+        // edges of a cell the normalized direction (dx, dy) crosses (same bits as the edges of a cell)
+        static uint32_t crossed_edges(const int32_t dx, const int32_t dy) {
+            return (uint32_t)(dx < 0) | ((uint32_t)(dx > 0) << 1) | ((uint32_t)(dy < 0) << 2) | ((uint32_t)(dy > 0) << 3);
+        }
+
+        // Fill the table for a width x height gameboard (has to fit into the storage)
+        void build(const int32_t Width, const int32_t Height, const bool Loop_x, const bool Loop_y) {
+
+            assert(Width > 0 && Height > 0 && Width <= 256 && Height <= 256 && Width * Height <= this->capacity && Width * Height < Cell::None);
+            this->width = Width;
+            this->height = Height;
+            this->loop_x = Loop_x;
+            this->loop_y = Loop_y;
+
+            for (int32_t y = 0; y < Height; ++y) {
+                for (int32_t x = 0; x < Width; ++x) {
+                    const int32_t cell = (y * Width) + x;
+                    this->xs[cell] = (uint8_t) x;
+                    this->ys[cell] = (uint8_t) y;
+                    this->edges[cell] = (uint8_t)((x == 0) | ((x == Width - 1) << 1) | ((y == 0) << 2) | ((y == Height - 1) << 3));
+                    for (int32_t dy = -1; dy <= 1; ++dy) {
+                        for (int32_t dx = -1; dx <= 1; ++dx) {
+                            if (dx == 0 && dy == 0) { continue; }
+                            int32_t next_x = x + dx;
+                            int32_t next_y = y + dy;
+                            uint16_t next = Cell::None;
+                            if ((next_x >= 0 && next_x < Width) || Loop_x) {
+                                if ((next_y >= 0 && next_y < Height) || Loop_y) {
+                                    next_x = (next_x + Width) % Width;
+                                    next_y = (next_y + Height) % Height;
+                                    next = (uint16_t)((next_y * Width) + next_x);
+                                }
+                            }
+                            this->next_cells[(cell * directions) + direction_index(dx, dy)] = next;
+                        }
+                    }
+                }
+            }
+        }
+
+        // check if the table was built for this gameboard
+        bool matches(const int32_t Width, const int32_t Height, const bool Loop_x, const bool Loop_y) const {
+            return this->width == Width && this->height == Height && this->loop_x == Loop_x && this->loop_y == Loop_y;
+        }
+
+        // cell after moving by the direction with direction_index() dir_index (Cell::None if this leaves the gameboard)
+        Cell next(const Cell& cell, const int32_t dir_index) const { return Cell(this->next_cells[(cell.index * directions) + dir_index]); }
+
+        Position position(const Cell& cell) const { return Position(this->xs[cell.index], this->ys[cell.index]); }
+
+        // Wrap flags of the move from cell by the normalized direction (dx, dy), if it stays on the gameboard
+        uint32_t wraps(const Cell& cell, const int32_t dx, const int32_t dy) const {
+            const uint32_t crossed = this->edges[cell.index] & crossed_edges(dx, dy);
+            return (uint32_t)((crossed & 0x3) != 0) | ((uint32_t)((crossed & 0xC) != 0) << 1);
+        }
+};
+
+// Storage of a NeighbourTable for gameboards up to MaxCells cells (e.g. a static of the game task)
+template <int32_t MaxCells>
+class NeighbourStorage: public NeighbourTable {
+
+    protected:
 
+        uint16_t next_storage[MaxCells * directions];
+        uint8_t edge_storage[MaxCells];
+        uint8_t x_storage[MaxCells];
+        uint8_t y_storage[MaxCells];
 
     public:
 
+        NeighbourStorage(): NeighbourTable(this->next_storage, this->edge_storage, this->x_storage, this->y_storage, MaxCells) {}
+
+        // the table points into this object
+        NeighbourStorage(const NeighbourStorage&) = delete;
+        NeighbourStorage& operator=(const NeighbourStorage&) = delete;
 };
 
 class GameBoard {
@@ -218,6 +360,9 @@ class GameBoard {
 
         CRGB board_color;
 
+        // moves and positions of every cell (see attach()), shared by all copies of the gameboard
+        const NeighbourTable* neighbours;
+
     public:
 
         GameBoard(const int32_t Width, const int32_t Height,
@@ -228,12 +373,117 @@ class GameBoard {
         loop_x(Loop_x), loop_y(Loop_y), \
         invert_x_movement(Invert_x), \
         invert_y_movement(Invert_y), \
-        board_color(Board_color) {}
+        board_color(Board_color), neighbours(nullptr) {}
+
+        /* Build table for this gameboard and use it for next() and position(). The copies of the gameboard share the table,
+         * so don't build it for another gameboard while they are in use.
+         */
+        GameBoard& attach(NeighbourTable& table) {
+            table.build(this->width, this->height, this->loop_x, this->loop_y);
+            this->neighbours = &table;
+            return *this;
+        }
 
         uint32_t size() const { return this->width * this->height; }
 
+        // conversion between Position and Cell (for gameboards with less than 65535 cells), a Cell is looked up in the neighbour table
+        Cell cell(const Position& pos) const { return Cell((pos.y * this->width) + pos.x); }
+        const Cell& cell(const Cell& cell) const { return cell; }
+        Position position(const Cell& cell) const { return this->neighbours->position(cell); }
+        const Position& position(const Position& pos) const { return pos; }
+
+        // cell after moving from cell by the normalized direction dir other than None (Cell::None if the snake would leave the gameboard)
+        Cell next(const Cell& cell, const Direction& dir) const { return this->neighbours->next(cell, NeighbourTable::direction_index(dir.x, dir.y)); }
+
+        // NeighbourTable::Wrap flags of the move from cell by dir (if it stays on the gameboard)
+        uint32_t wraps(const Cell& cell, const Direction& dir) const { return this->neighbours->wraps(cell, dir.x, dir.y); }
+
+        // distance along one axis (shortest way around if the axis loops)
+        static int32_t axis_distance(const int32_t from, const int32_t to, const int32_t extent, const bool loop) {
+            const int32_t d = (to > from) ? (to - from) : (from - to);
+            return (loop && (extent - d) < d) ? (extent - d) : d;
+        }
+
+        // signed step along one axis (-1, 0 or 1) on the shortest way from -> to
+        static int32_t axis_step(const int32_t from, const int32_t to, const int32_t extent, const bool loop) {
+            const int32_t d = to - from;
+            const int32_t step = (d > 0) ? 1 : ((d < 0) ? -1 : 0);
+            if (loop && 2 * ((d < 0) ? -d : d) > extent) { return -step; }
+            return step;
+        }
+
+        // Manhattan distance, taking the loop flags into account
+        int32_t distance_manhattan(const Position& p1, const Position& p2) const {
+            return axis_distance(p1.x, p2.x, this->width, this->loop_x) + axis_distance(p1.y, p2.y, this->height, this->loop_y);
+        }
+
+        // normalized direction from start_point towards end_point, taking the loop flags into account
+        Direction direction(const Position& start_point, const Position& end_point) const {
+            return Direction(
+                axis_step(start_point.x, end_point.x, this->width, this->loop_x),
+                axis_step(start_point.y, end_point.y, this->height, this->loop_y)
+            );
+        }
+
 };
 
+/* Movement rules of a gameboard fixed at compile time, e.g. Rules<true, true, false, false> for a gameboard
+ * which loops in both directions without inverted movement. Code templated on the rules (like game_tick())
+ * folds the rule checks into constants, e.g. the inversion and the edge check of a gameboard which loops in
+ * both directions disappear. RuntimeRules is the adapter which reads the rules from a GameBoard.
+ */
+template <bool LoopX, bool LoopY, bool InvertX, bool InvertY>
+class Rules {
+
+    public:
+
+        Rules() {}
+
+        bool loop_x() const { return LoopX; }
+        bool loop_y() const { return LoopY; }
+
+        // check if game_board follows these rules
+        static bool matches(const GameBoard& game_board) {
+            return game_board.loop_x == LoopX && game_board.loop_y == LoopY && game_board.invert_x_movement == InvertX && game_board.invert_y_movement == InvertY;
+        }
+
+        // movement on the gameboard for the direction the player asked for
+        int32_t move_x(const int32_t dx) const { return InvertX ? -dx : dx; }
+        int32_t move_y(const int32_t dy) const { return InvertY ? -dy : dy; }
+
+        // gameboard which follows these rules
+        static GameBoard game_board(const int32_t width, const int32_t height, CRGB board_color = CRGB::Black) {
+            return GameBoard(width, height, LoopX, LoopY, InvertX, InvertY, board_color);
+        }
+};
+
+class RuntimeRules {
+
+    protected:
+
+        bool loop_x_;
+        bool loop_y_;
+        bool invert_x;
+        bool invert_y;
+
+    public:
+
+        RuntimeRules(const GameBoard& game_board):
+            loop_x_(game_board.loop_x), loop_y_(game_board.loop_y),
+            invert_x(game_board.invert_x_movement), invert_y(game_board.invert_y_movement) {}
+
+        bool loop_x() const { return this->loop_x_; }
+        bool loop_y() const { return this->loop_y_; }
+
+        bool matches(const GameBoard& game_board) const {
+            return game_board.loop_x == this->loop_x_ && game_board.loop_y == this->loop_y_ && game_board.invert_x_movement == this->invert_x && game_board.invert_y_movement == this->invert_y;
+        }
+
+        int32_t move_x(const int32_t dx) const { return this->invert_x ? -dx : dx; }
+        int32_t move_y(const int32_t dy) const { return this->invert_y ? -dy : dy; }
+};
+
+
 
 Direction get_direction_from_ps4_control_pad();
 Direction get_direction_from_ps4_analog_stick(const bool left_stick = true, const uint32_t magnitude_thershold = 100);
@@ -0,0 +1,93 @@
+#include <Arduino.h>
+
+#include "GameLog.h"
+#include "esp_timer.h"
+
+namespace Game {
+
+LogRing game_log;
+
+// shared by all rings, held only to copy a record
+static portMUX_TYPE log_lock = portMUX_INITIALIZER_UNLOCKED;
+
+
+const char* LogRing::level_name(const uint8_t level) {
+    switch (level) {
+        case GAME_LOG_LEVEL_ERROR: return "E";
+        case GAME_LOG_LEVEL_WARN: return "W";
+        case GAME_LOG_LEVEL_INFO: return "I";
+        case GAME_LOG_LEVEL_DEBUG: return "D";
+        default: return "?";
+    }
+}
+
+void LogRing::drain_task(void* args) {
+
+    LogRing* ring = (LogRing*) args;
+
+    while (true) {
+        ring->drain();
+        vTaskDelay(pdMS_TO_TICKS(ring->period_ms));
+    }
+}
+
+bool LogRing::begin(const BaseType_t core, const UBaseType_t priority, const uint32_t Period_ms) {
+
+    if (this->task != nullptr) { return true; }
+    this->period_ms = Period_ms;
+    return (xTaskCreatePinnedToCore(drain_task, "Log-Task", 4096, this, priority, &this->task, core) == pdPASS);
+}
+
+void LogRing::write_record(const uint8_t level, const char* format, const int32_t* args, const int32_t arg_count) {
+
+    const int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&log_lock);
+    if (this->head - this->tail >= (uint32_t) capacity) {
+        this->dropped += 1;
+    }
+    else {
+        LogRecord& record = this->records[this->head % capacity];
+        record.format = format;
+        record.level = level;
+        record.arg_count = arg_count;
+        record.time_us = now;
+        for (int32_t i = 0; i < LogRecord::max_args; ++i) { record.args[i] = (i < arg_count) ? args[i] : 0; }
+        this->head += 1;
+    }
+    portEXIT_CRITICAL(&log_lock);
+}
+
+int32_t LogRing::drain() {
+
+    int32_t printed = 0;
+    while (true) {
+
+        // take the oldest record (printing happens outside of the lock)
+        LogRecord record;
+        uint32_t dropped = 0;
+        portENTER_CRITICAL(&log_lock);
+        const bool empty = (this->tail == this->head);
+        if (!empty) {
+            record = this->records[this->tail % capacity];
+            this->tail += 1;
+        }
+        else {
+            dropped = this->dropped;
+            this->dropped = 0;
+        }
+        portEXIT_CRITICAL(&log_lock);
+
+        if (empty) {
+            if (dropped > 0) { printf("[%10lld] W log ring full, %u messages dropped\n", (long long) esp_timer_get_time(), dropped); }
+            return printed;
+        }
+
+        printf("[%10lld] %s ", (long long) record.time_us, level_name(record.level));
+        printf(record.format, record.args[0], record.args[1], record.args[2], record.args[3]);
+        printf("\n");
+        printed += 1;
+    }
+}
+
+}; // namespace Game
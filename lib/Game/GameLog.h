@@ -0,0 +1,107 @@
+#pragma once
+
+#include "stdint.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Log levels, messages above GAME_LOG_LEVEL are removed at compile time
+#define GAME_LOG_LEVEL_NONE  0
+#define GAME_LOG_LEVEL_ERROR 1
+#define GAME_LOG_LEVEL_WARN  2
+#define GAME_LOG_LEVEL_INFO  3
+#define GAME_LOG_LEVEL_DEBUG 4
+
+#ifndef GAME_LOG_LEVEL
+#define GAME_LOG_LEVEL GAME_LOG_LEVEL_INFO
+#endif
+
+namespace Game {
+
+// One log message: printf format (a string literal) and up to 4 integer arguments
+class LogRecord {
+
+    public:
+
+        static const int32_t max_args = 4;
+
+        const char* format;
+        uint8_t level;
+        uint8_t arg_count;
+        int64_t time_us; // esp_timer_get_time() when the message was logged
+        int32_t args[max_args];
+};
+
+/* Log messages as records in a ring in RAM instead of printing them where they happen.
+ * Writing a record copies a few words (no formatting, no UART), a task with low priority formats
+ * and prints the records in the background. If the ring is full new records are dropped and counted.
+ * Use the GAME_LOG_* macros, formats may only contain integer conversions (%d, %u, %x, ...).
+ */
+class LogRing {
+
+    public:
+
+        static const int32_t capacity = 64;
+
+    protected:
+
+        LogRecord records[capacity];
+        uint32_t head; // next record to write
+        uint32_t tail; // next record to print
+        TaskHandle_t task;
+        uint32_t period_ms;
+
+        static void drain_task(void* args);
+
+    public:
+
+        uint32_t dropped;
+
+    public:
+
+        LogRing(): head(0), tail(0), task(nullptr), period_ms(50), dropped(0) {}
+
+        // Create the task which prints the records (every period_ms)
+        bool begin(const BaseType_t core = 0, const UBaseType_t priority = 1, const uint32_t Period_ms = 50);
+
+        template <typename... Args>
+        void write(const uint8_t level, const char* format, Args... args) {
+            static_assert(sizeof...(Args) <= LogRecord::max_args, "too many log arguments");
+            const int32_t values[] = { ((int32_t) args)..., 0 };
+            this->write_record(level, format, values, sizeof...(Args));
+        }
+
+        void write_record(const uint8_t level, const char* format, const int32_t* args, const int32_t arg_count);
+
+        // Print all records in the ring, returns the number of printed records
+        int32_t drain();
+
+        static const char* level_name(const uint8_t level);
+};
+
+extern LogRing game_log;
+
+}; // namespace Game
+
+#if GAME_LOG_LEVEL >= GAME_LOG_LEVEL_ERROR
+#define GAME_LOG_ERROR(...) Game::game_log.write(GAME_LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define GAME_LOG_ERROR(...) do {} while (0)
+#endif
+
+#if GAME_LOG_LEVEL >= GAME_LOG_LEVEL_WARN
+#define GAME_LOG_WARN(...) Game::game_log.write(GAME_LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define GAME_LOG_WARN(...) do {} while (0)
+#endif
+
+#if GAME_LOG_LEVEL >= GAME_LOG_LEVEL_INFO
+#define GAME_LOG_INFO(...) Game::game_log.write(GAME_LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define GAME_LOG_INFO(...) do {} while (0)
+#endif
+
+#if GAME_LOG_LEVEL >= GAME_LOG_LEVEL_DEBUG
+#define GAME_LOG_DEBUG(...) Game::game_log.write(GAME_LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define GAME_LOG_DEBUG(...) do {} while (0)
+#endif
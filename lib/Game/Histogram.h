@@ -0,0 +1,97 @@
+#pragma once
+
+#include "stdint.h"
+
+/* Fixed size histogram for durations (or any other unsigned value).
+ * Values below 16 get their own bucket, above that every power of two is split into 8 buckets,
+ * so percentiles are exact for small values and within 12.5% for large ones.
+ * The histogram doesn't allocate, recording a value is a handful of instructions.
+ */
+class Histogram {
+
+    public:
+
+        static const int32_t linear_buckets = 16;
+        static const int32_t sub_buckets = 8;
+        static const int32_t bucket_count = linear_buckets + (32 - 4) * sub_buckets;
+
+    protected:
+
+        uint32_t buckets[bucket_count];
+        uint32_t count_;
+        uint32_t min_;
+        uint32_t max_;
+        uint64_t sum_;
+
+        static int32_t log2(uint32_t value) {
+            int32_t result = 0;
+            while (value >>= 1) { ++result; }
+            return result;
+        }
+
+    public:
+
+        static int32_t bucket_index(const uint32_t value) {
+            if (value < (uint32_t) linear_buckets) { return value; }
+            const int32_t exponent = log2(value); // >= 4
+            const int32_t sub = (value >> (exponent - 3)) & (sub_buckets - 1);
+            return linear_buckets + ((exponent - 4) * sub_buckets) + sub;
+        }
+
+        // largest value which falls into bucket index
+        static uint32_t bucket_upper_bound(const int32_t index) {
+            if (index < linear_buckets) { return index; }
+            const int32_t exponent = ((index - linear_buckets) / sub_buckets) + 4;
+            const uint32_t sub = (index - linear_buckets) % sub_buckets;
+            const uint32_t lower = (((uint32_t) sub_buckets + sub) << (exponent - 3));
+            return lower + (1U << (exponent - 3)) - 1;
+        }
+
+        Histogram() { this->clear(); }
+
+        void clear() {
+            for (auto& bucket : this->buckets) { bucket = 0; }
+            this->count_ = 0;
+            this->min_ = UINT32_MAX;
+            this->max_ = 0;
+            this->sum_ = 0;
+        }
+
+        void record(const uint32_t value) {
+            this->buckets[bucket_index(value)] += 1;
+            this->count_ += 1;
+            this->sum_ += value;
+            if (value < this->min_) { this->min_ = value; }
+            if (value > this->max_) { this->max_ = value; }
+        }
+
+        void merge(const Histogram& other) {
+            for (int32_t i = 0; i < bucket_count; ++i) { this->buckets[i] += other.buckets[i]; }
+            this->count_ += other.count_;
+            this->sum_ += other.sum_;
+            if (other.min_ < this->min_) { this->min_ = other.min_; }
+            if (other.max_ > this->max_) { this->max_ = other.max_; }
+        }
+
+        uint32_t count() const { return this->count_; }
+        uint32_t min() const { return (this->count_ > 0) ? this->min_ : 0; }
+        uint32_t max() const { return this->max_; }
+        uint64_t sum() const { return this->sum_; }
+        uint32_t mean() const { return (this->count_ > 0) ? (uint32_t)(this->sum_ / this->count_) : 0; }
+
+        // value below which percent (0-100) of all recorded values lie (upper bound of the bucket)
+        uint32_t percentile(const uint32_t percent) const {
+            if (this->count_ == 0) { return 0; }
+            const uint64_t rank = (((uint64_t) this->count_ * percent) + 99) / 100;
+            uint64_t seen = 0;
+            for (int32_t i = 0; i < bucket_count; ++i) {
+                seen += this->buckets[i];
+                if (seen >= rank && seen > 0) {
+                    const uint32_t bound = bucket_upper_bound(i);
+                    return (bound < this->max_) ? bound : this->max_;
+                }
+            }
+            return this->max_;
+        }
+
+};
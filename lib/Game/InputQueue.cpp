@@ -0,0 +1,95 @@
+#include <Arduino.h>
+
+#include "InputQueue.h"
+#include "esp_timer.h"
+#include <PS4Controller.h>
+
+namespace Game {
+
+InputQueue ps4_input;
+
+
+void InputQueue::ps4_event_callback(const ps4_t& data, const ps4_event_t& event) {
+
+    const int64_t now = data.timestamp_us; // when the packet was parsed
+    const ps4_button_t& down = event.button_down;
+    if (!ps4_button_any(down, ps4_button_mask_arrows)) { return; } // most packets only move the sticks
+
+    if (down.up) { ps4_input.push(Direction::Up, now); }
+    if (down.down) { ps4_input.push(Direction::Down, now); }
+    if (down.left) { ps4_input.push(Direction::Left, now); }
+    if (down.right) { ps4_input.push(Direction::Right, now); }
+    if (down.upright) { ps4_input.push(Direction::UpRight, now); }
+    if (down.upleft) { ps4_input.push(Direction::UpLeft, now); }
+    if (down.downleft) { ps4_input.push(Direction::DownLeft, now); }
+    if (down.downright) { ps4_input.push(Direction::DownRight, now); }
+}
+
+bool InputQueue::begin() {
+
+    if (this->queue == nullptr) {
+        this->queue = xQueueCreate(capacity, sizeof(InputEvent));
+        if (this->queue == nullptr) { return false; }
+    }
+    PS4.attach(ps4_event_callback);
+    return true;
+}
+
+bool InputQueue::push(const Direction& dir, const int64_t time_us) {
+
+    if (this->queue == nullptr) { return false; }
+
+    InputEvent event;
+    event.time_us = time_us;
+    event.x = dir.x;
+    event.y = dir.y;
+    this->received += 1;
+    if (xQueueSend(this->queue, &event, 0) != pdTRUE) {
+        this->overflows += 1;
+        return false;
+    }
+    return true;
+}
+
+bool InputQueue::next_turn(const Direction& current, Direction& dir, int64_t* input_time_us, const int64_t max_age_us) {
+
+    if (this->queue == nullptr) { return false; }
+
+    const int64_t now = esp_timer_get_time();
+    InputEvent event;
+    while (xQueueReceive(this->queue, &event, 0) == pdTRUE) {
+
+        if (now - event.time_us > max_age_us) { this->dropped_stale += 1; continue; }
+
+        // we can't go back (and going on isn't a turn)
+        if ((event.x + current.x == 0 && event.y + current.y == 0) || (event.x == current.x && event.y == current.y)) {
+            this->dropped_reverse += 1;
+            continue;
+        }
+
+        dir.set_xy(event.x, event.y);
+        if (input_time_us != nullptr) { *input_time_us = event.time_us; }
+        this->taken += 1;
+        return true;
+    }
+    return false;
+}
+
+void InputQueue::clear() {
+    if (this->queue != nullptr) { xQueueReset(this->queue); }
+}
+
+void InputQueue::print_stats() const {
+    printf("PS4-Input: received = %u, taken = %u, overflows = %u, stale = %u, reverse = %u\n",
+        this->received, this->taken, this->overflows, this->dropped_stale, this->dropped_reverse);
+}
+
+void InputQueue::clear_stats() {
+    this->received = 0;
+    this->overflows = 0;
+    this->taken = 0;
+    this->dropped_stale = 0;
+    this->dropped_reverse = 0;
+}
+
+}; // namespace Game
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "stdint.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include <PS4Controller.h>
+#include "Game.h"
+
+namespace Game {
+
+// Direction button pressed on the controller
+class InputEvent {
+
+    public:
+
+        int64_t time_us; // esp_timer_get_time() when the HID packet was parsed
+        int8_t x;
+        int8_t y;
+};
+
+/* Direction buttons pressed on the PS4 controller, in the order they were pressed.
+ * The event callback of the PS4 library pushes every button_down edge, so a press shorter than a tick
+ * or two turns within one tick aren't lost. The game takes one turn per tick with next_turn().
+ */
+class InputQueue {
+
+    public:
+
+        static const int32_t capacity = 4; // buffered turns
+
+    protected:
+
+        QueueHandle_t queue;
+
+        static void ps4_event_callback(const ps4_t& data, const ps4_event_t& event);
+
+    public:
+
+        // written by the event callback
+        uint32_t received;
+        uint32_t overflows; // queue was full
+
+        // written by the game
+        uint32_t taken;
+        uint32_t dropped_stale;
+        uint32_t dropped_reverse; // turn into the opposite direction (or no turn at all)
+
+    public:
+
+        InputQueue(): queue(nullptr), received(0), overflows(0), taken(0), dropped_stale(0), dropped_reverse(0) {}
+
+        // Create the queue and attach the event callback of the PS4 controller
+        bool begin();
+
+        bool push(const Direction& dir, const int64_t time_us);
+
+        /* Oldest buffered turn which changes current (the direction of the last tick as the player sees it),
+         * turns into the opposite direction and presses older than max_age_us are dropped.
+         * input_time_us (if given) is set to the time the HID packet of the turn was parsed.
+         * Returns false if there is no such turn.
+         */
+        bool next_turn(const Direction& current, Direction& dir, int64_t* input_time_us = nullptr, const int64_t max_age_us = 1000000);
+
+        // drop all buffered turns
+        void clear();
+
+        void print_stats() const;
+        void clear_stats();
+};
+
+extern InputQueue ps4_input;
+
+}; // namespace Game
@@ -0,0 +1,31 @@
+#include <Arduino.h>
+
+#include "Latency.h"
+
+namespace Game {
+
+
+const char* LatencyStats::stage_name(const int32_t stage) {
+    switch (stage) {
+        case Stage_Input: return "input";
+        case Stage_Tick: return "tick";
+        case Stage_Draw: return "draw";
+        case Stage_Show: return "show";
+        case Stage_Total: return "total";
+        default: return "unknown";
+    }
+}
+
+void LatencyStats::print_json() const {
+
+    printf("{\"latency_us\":{");
+    for (int32_t i = 0; i < Stage_Count; ++i) {
+        const Histogram& stage = this->stages[i];
+        printf("%s\"%s\":{\"count\":%u,\"min\":%u,\"mean\":%u,\"p50\":%u,\"p90\":%u,\"p99\":%u,\"max\":%u}",
+            (i > 0) ? "," : "", stage_name(i), stage.count(), stage.min(), stage.mean(),
+            stage.percentile(50), stage.percentile(90), stage.percentile(99), stage.max());
+    }
+    printf("}}\n");
+}
+
+}; // namespace Game
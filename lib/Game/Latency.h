@@ -0,0 +1,58 @@
+#pragma once
+
+#include "stdint.h"
+#include "Histogram.h"
+
+namespace Game {
+
+// Timestamps (esp_timer_get_time()) of one controller input on its way to the LEDs
+class LatencyTrace {
+
+    public:
+
+        int64_t input_us; // HID packet parsed (ps4_parse_packet())
+        int64_t resolved_us; // direction taken by the game
+        int64_t ticked_us; // game_tick() done
+        int64_t drawn_us; // draw() done
+        int64_t shown_us; // FastLED.show() done
+
+        LatencyTrace(): input_us(0), resolved_us(0), ticked_us(0), drawn_us(0), shown_us(0) {}
+};
+
+/* Latency from a controller input to the light on the strip, per stage and in total.
+ * Every stage is a fixed size Histogram, so recording doesn't allocate.
+ */
+class LatencyStats {
+
+    public:
+
+        enum Stage : int32_t {
+            Stage_Input = 0, // packet -> direction taken (waiting for the next tick)
+            Stage_Tick = 1, // game_tick()
+            Stage_Draw = 2, // draw()
+            Stage_Show = 3, // FastLED.show()
+            Stage_Total = 4, // packet -> LEDs
+            Stage_Count = 5,
+        };
+
+        Histogram stages[Stage_Count];
+
+    public:
+
+        static const char* stage_name(const int32_t stage);
+
+        void record(const LatencyTrace& trace) {
+            this->stages[Stage_Input].record(trace.resolved_us - trace.input_us);
+            this->stages[Stage_Tick].record(trace.ticked_us - trace.resolved_us);
+            this->stages[Stage_Draw].record(trace.drawn_us - trace.ticked_us);
+            this->stages[Stage_Show].record(trace.shown_us - trace.drawn_us);
+            this->stages[Stage_Total].record(trace.shown_us - trace.input_us);
+        }
+
+        void clear() { for (auto& stage : this->stages) { stage.clear(); } }
+
+        // Print all stages as one line of JSON
+        void print_json() const;
+};
+
+}; // namespace Game
@@ -0,0 +1,101 @@
+#include <Arduino.h>
+
+#include "Profiler.h"
+#include "GameLog.h"
+
+namespace Game {
+
+
+const char* TickProfiler::phase_name(const int32_t phase) {
+    switch (phase) {
+        case Phase_Input: return "input";
+        case Phase_Ai: return "ai";
+        case Phase_Move: return "move";
+        case Phase_Bite: return "bite";
+        case Phase_Fruit: return "fruit";
+        case Phase_Draw: return "draw";
+        case Phase_Show: return "show";
+        case Phase_Tick: return "tick";
+        default: return "unknown";
+    }
+}
+
+// log formats per phase (the log keeps the pointer to the format, not a copy)
+static const char* const phase_log_formats[TickProfiler::Phase_Count] = {
+    "profile input: min %u avg %u max %u p99 %u ns",
+    "profile ai: min %u avg %u max %u p99 %u ns",
+    "profile move: min %u avg %u max %u p99 %u ns",
+    "profile bite: min %u avg %u max %u p99 %u ns",
+    "profile fruit: min %u avg %u max %u p99 %u ns",
+    "profile draw: min %u avg %u max %u p99 %u ns",
+    "profile show: min %u avg %u max %u p99 %u ns",
+    "profile tick: min %u avg %u max %u p99 %u ns",
+};
+
+TickProfiler::TickProfiler(): marked(0), tick_start(0), last_mark(0), ticks(0), windows(0) {
+#if defined(__XTENSA__)
+    this->cycles_per_us = ESP.getCpuFreqMHz();
+#else
+    this->cycles_per_us = 1000; // nanoseconds
+#endif
+    for (int32_t i = 0; i < Phase_Count; ++i) {
+        this->tick_cycles[i] = 0;
+        this->last[i] = Summary{0, 0, 0, 0, 0};
+    }
+}
+
+void TickProfiler::end_tick() {
+
+    this->tick_cycles[Phase_Tick] = cycle_count() - this->tick_start;
+    this->marked |= (1U << Phase_Tick);
+
+    for (int32_t i = 0; i < Phase_Count; ++i) {
+        if ((this->marked >> i) & 1) { this->window[i].record(this->tick_cycles[i]); }
+    }
+
+    this->ticks += 1;
+    if (this->ticks >= window_ticks) { this->close_window(); }
+}
+
+TickProfiler::Summary TickProfiler::current(const int32_t phase) const {
+
+    const Histogram& cycles = this->window[phase];
+    const uint64_t cycles_per_us = this->cycles_per_us;
+    Summary summary;
+    summary.count = cycles.count();
+    summary.min_ns = (uint32_t)((1000ULL * cycles.min()) / cycles_per_us);
+    summary.mean_ns = (uint32_t)((1000ULL * cycles.mean()) / cycles_per_us);
+    summary.max_ns = (uint32_t)((1000ULL * cycles.max()) / cycles_per_us);
+    summary.p99_ns = (uint32_t)((1000ULL * cycles.percentile(99)) / cycles_per_us);
+    return summary;
+}
+
+void TickProfiler::close_window() {
+
+    for (int32_t i = 0; i < Phase_Count; ++i) {
+        this->last[i] = this->current(i);
+        this->window[i].clear();
+        if (this->last[i].count > 0) {
+            GAME_LOG_INFO(phase_log_formats[i], this->last[i].min_ns, this->last[i].mean_ns, this->last[i].max_ns, this->last[i].p99_ns);
+        }
+    }
+    this->ticks = 0;
+    this->windows += 1;
+}
+
+void TickProfiler::print_json() const {
+
+    printf("{\"profile_ns\":{\"window_ticks\":%u,\"windows\":%u", window_ticks, this->windows);
+    for (int32_t w = 0; w < 2; ++w) {
+        printf(",\"%s\":{", (w == 0) ? "last" : "current");
+        for (int32_t i = 0; i < Phase_Count; ++i) {
+            const Summary summary = (w == 0) ? this->last[i] : this->current(i);
+            printf("%s\"%s\":{\"count\":%u,\"min\":%u,\"avg\":%u,\"max\":%u,\"p99\":%u}", (i > 0) ? "," : "",
+                phase_name(i), summary.count, summary.min_ns, summary.mean_ns, summary.max_ns, summary.p99_ns);
+        }
+        printf("}");
+    }
+    printf("}}\n");
+}
+
+}; // namespace Game
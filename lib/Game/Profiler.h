@@ -0,0 +1,105 @@
+#pragma once
+
+#include "stdint.h"
+#include "Histogram.h"
+#if !defined(__XTENSA__)
+#include <chrono>
+#endif
+
+namespace Game {
+
+// Cycle counter (CCOUNT) on the ESP32, nanoseconds of std::chrono::steady_clock on the host
+inline uint32_t cycle_count() {
+#if defined(__XTENSA__)
+    uint32_t ccount;
+    __asm__ __volatile__("rsr %0, ccount" : "=a"(ccount));
+    return ccount;
+#else
+    return (uint32_t) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// Phase markers for game_tick() when nothing is profiled
+class NoProbe {
+    public:
+        void mark(const int32_t) {}
+};
+
+/* Time spent in every phase of a game tick, min/avg/max/p99 over a window of window_ticks ticks.
+ * start() begins a tick, mark(phase) adds the time since the last mark to phase and end_tick() records the tick.
+ * A phase which isn't marked in a tick (e.g. the AI while a player is playing) isn't recorded for that tick.
+ * When a window is complete its summary is kept for print_json() and written to the log, then the next window starts.
+ */
+class TickProfiler {
+
+    public:
+
+        enum Phase : int32_t {
+            Phase_Input = 0, // controller input
+            Phase_Ai = 1, // AI direction (plan or fallback AI)
+            Phase_Move = 2, // inversion, wrap and move
+            Phase_Bite = 3, // bite check
+            Phase_Fruit = 4, // fruit check and new fruit
+            Phase_Draw = 5, // draw()
+            Phase_Show = 6, // FastLED.show()
+            Phase_Tick = 7, // from start() to end_tick()
+            Phase_Count = 8,
+        };
+
+        class Summary {
+            public:
+                uint32_t count;
+                uint32_t min_ns;
+                uint32_t mean_ns;
+                uint32_t max_ns;
+                uint32_t p99_ns;
+        };
+
+        static const uint32_t window_ticks = 256;
+
+    protected:
+
+        Histogram window[Phase_Count]; // cycles of the current window
+        uint32_t tick_cycles[Phase_Count]; // of the current tick
+        uint32_t marked; // phases marked in the current tick (bit mask)
+        uint32_t tick_start;
+        uint32_t last_mark;
+        uint32_t ticks; // in the current window
+        uint32_t cycles_per_us;
+
+        void close_window();
+
+    public:
+
+        Summary last[Phase_Count]; // of the last complete window
+        uint32_t windows;
+
+    public:
+
+        TickProfiler();
+
+        void start() {
+            this->tick_start = cycle_count();
+            this->last_mark = this->tick_start;
+            this->marked = 0;
+        }
+
+        void mark(const int32_t phase) {
+            const uint32_t now = cycle_count();
+            this->tick_cycles[phase] = ((this->marked >> phase) & 1) ? (this->tick_cycles[phase] + (now - this->last_mark)) : (now - this->last_mark);
+            this->marked |= (1U << phase);
+            this->last_mark = now;
+        }
+
+        void end_tick();
+
+        // Summary of the current (incomplete) window
+        Summary current(const int32_t phase) const;
+
+        // Print the last complete window and the current one as one line of JSON
+        void print_json() const;
+
+        static const char* phase_name(const int32_t phase);
+};
+
+}; // namespace Game
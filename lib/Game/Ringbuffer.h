@@ -63,6 +63,12 @@ class Ringbuffer : protected std::vector<T> {
         // size
         int32_t size() const { return this->parent::size(); }
 
+        // number of elements which fit into the allocated storage
+        int32_t capacity() const { return this->parent::capacity(); }
+
+        // allocate storage for n elements, inserting up to n elements doesn't allocate memory afterwards
+        void reserve(const int32_t n) { this->parent::reserve(n); }
+
         // index substitution
         int32_t ring_idx_to_vec_idx(const int32_t index) const {
             if (this->size() > 0) {
@@ -872,6 +878,12 @@ class Ringbuffer : protected std::vector<T> {
             return iterator(this, first.index);
         }
 
+        // Replace the content by n copies of val (keeps the storage if n fits into it)
+        void assign(const int32_t n, const value_type& val) {
+            this->front_index = 0;
+            this->parent::assign(n, val);
+        }
+
         // Clear container content
         void clear() {
             this->front_index = 0;
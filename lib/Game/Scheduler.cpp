@@ -0,0 +1,139 @@
+#include <Arduino.h>
+
+#include "Scheduler.h"
+#include "GameLog.h"
+
+namespace Game {
+
+
+TickScheduler::TickScheduler():
+    timer(nullptr), events(nullptr), deadline_us_(0), next_tick_us_(0), interval_us(0), last_tick_us(0), last_interval_us(0),
+    late(0), missed(0), windows(0)
+{
+    this->last = Summary{0, 0, 0, 0, 0, 0, 0, 0};
+}
+
+void TickScheduler::timer_callback(void* args) {
+    TickScheduler* scheduler = (TickScheduler*) args;
+    xEventGroupSetBits(scheduler->events, timer_bit);
+}
+
+bool TickScheduler::begin() {
+
+    if (this->timer != nullptr) { return true; }
+
+    this->events = xEventGroupCreateStatic(&this->events_buffer);
+    if (this->events == nullptr) { return false; }
+    esp_timer_create_args_t timer_args = {};
+    timer_args.callback = timer_callback;
+    timer_args.arg = this;
+    timer_args.dispatch_method = ESP_TIMER_TASK;
+    timer_args.name = "game_tick";
+    if (esp_timer_create(&timer_args, &this->timer) != ESP_OK) {
+        this->timer = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void TickScheduler::start(const int64_t now_us) {
+    this->deadline_us_ = now_us;
+    this->next_tick_us_ = now_us;
+    this->last_tick_us = 0;
+}
+
+void TickScheduler::wait_until(const int64_t wake_us) {
+
+    const int64_t until_us = (wake_us < this->next_tick_us_) ? wake_us : this->next_tick_us_;
+    const int64_t wait_us = until_us - esp_timer_get_time();
+    if (wait_us <= 0) { return; }
+
+    // without the timer only the FreeRTOS tick is left
+    if (this->timer == nullptr) {
+        vTaskDelay(pdMS_TO_TICKS((wait_us + 999) / 1000));
+        return;
+    }
+
+    esp_timer_stop(this->timer); // might still be armed if the task was woken otherwise
+    xEventGroupClearBits(this->events, timer_bit); // drop an expiry of an earlier wait
+    if (esp_timer_start_once(this->timer, wait_us) != ESP_OK) {
+        vTaskDelay(pdMS_TO_TICKS((wait_us + 999) / 1000));
+        return;
+    }
+
+    // the timeout only guards against a lost expiry
+    xEventGroupWaitBits(this->events, timer_bit, pdTRUE, pdFALSE, pdMS_TO_TICKS(wait_us / 1000) + 2);
+}
+
+int64_t TickScheduler::tick(const int64_t now_us) {
+
+    const int64_t lateness_us = now_us - this->next_tick_us_;
+    this->deadline_us_ = this->next_tick_us_;
+    this->lateness_us.record((lateness_us > 0) ? (uint32_t) lateness_us : 0);
+    if (lateness_us > late_us) { this->late += 1; }
+
+    // period against the interval it should have had
+    if (this->last_tick_us > 0) {
+        const int64_t jitter_us = (now_us - this->last_tick_us) - this->last_interval_us;
+        this->jitter_us.record((uint32_t)((jitter_us < 0) ? -jitter_us : jitter_us));
+    }
+    this->last_tick_us = now_us;
+
+    if (this->lateness_us.count() >= window_ticks) { this->close_window(); }
+    return lateness_us;
+}
+
+void TickScheduler::schedule_next(const int64_t Interval_us) {
+
+    this->interval_us = (Interval_us > 0) ? Interval_us : 1;
+    this->next_tick_us_ = this->deadline_us_ + this->interval_us;
+    this->last_interval_us = this->interval_us;
+
+    // ticks which couldn't start within their interval are dropped, the grid stays
+    const int64_t now_us = esp_timer_get_time();
+    while (this->next_tick_us_ + this->interval_us <= now_us) {
+        this->next_tick_us_ += this->interval_us;
+        this->last_interval_us += this->interval_us;
+        this->missed += 1;
+    }
+}
+
+TickScheduler::Summary TickScheduler::current() const {
+    Summary summary;
+    summary.ticks = this->lateness_us.count();
+    summary.late = this->late;
+    summary.missed = this->missed;
+    summary.mean_late_us = this->lateness_us.mean();
+    summary.p99_late_us = this->lateness_us.percentile(99);
+    summary.max_late_us = this->lateness_us.max();
+    summary.p99_jitter_us = this->jitter_us.percentile(99);
+    summary.max_jitter_us = this->jitter_us.max();
+    return summary;
+}
+
+void TickScheduler::close_window() {
+
+    this->last = this->current();
+    GAME_LOG_INFO("schedule: %u ticks, %u late, %u missed", this->last.ticks, this->last.late, this->last.missed);
+    GAME_LOG_INFO("schedule: late avg %u p99 %u max %u us", this->last.mean_late_us, this->last.p99_late_us, this->last.max_late_us);
+    GAME_LOG_INFO("schedule: jitter p99 %u max %u us", this->last.p99_jitter_us, this->last.max_jitter_us);
+    this->lateness_us.clear();
+    this->jitter_us.clear();
+    this->late = 0;
+    this->missed = 0;
+    this->windows += 1;
+}
+
+void TickScheduler::print_json() const {
+
+    printf("{\"schedule_us\":{\"window_ticks\":%u,\"windows\":%u,\"interval\":%lld", window_ticks, this->windows, (long long) this->interval_us);
+    for (int32_t w = 0; w < 2; ++w) {
+        const Summary summary = (w == 0) ? this->last : this->current();
+        printf(",\"%s\":{\"ticks\":%u,\"late\":%u,\"missed\":%u,\"late_avg\":%u,\"late_p99\":%u,\"late_max\":%u,\"jitter_p99\":%u,\"jitter_max\":%u}",
+            (w == 0) ? "last" : "current", summary.ticks, summary.late, summary.missed,
+            summary.mean_late_us, summary.p99_late_us, summary.max_late_us, summary.p99_jitter_us, summary.max_jitter_us);
+    }
+    printf("}}\n");
+}
+
+}; // namespace Game
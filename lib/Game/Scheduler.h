@@ -0,0 +1,95 @@
+#pragma once
+
+#include "stdint.h"
+#include "Histogram.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include "esp_timer.h"
+
+namespace Game {
+
+/* Ticks on a microsecond grid: an esp_timer wakes the waiting task at the deadline
+ * (instead of vTaskDelayUntil(), which rounds to the FreeRTOS tick).
+ * The timer sets a bit in an event group of the scheduler, the task notification of the task stays free for others.
+ * Every tick is due interval_us after the deadline of the previous one, so changing the interval
+ * takes effect with the next tick without drift. Ticks which are a whole interval late are dropped (missed),
+ * the others are recorded: lateness (start - deadline) and jitter (|period - interval|) per window of window_ticks ticks.
+ */
+class TickScheduler {
+
+    public:
+
+        static const uint32_t window_ticks = 256;
+        static const int64_t late_us = 1000; // a tick which starts later than this is counted as late
+
+        class Summary {
+            public:
+                uint32_t ticks;
+                uint32_t late; // started more than late_us after the deadline
+                uint32_t missed; // dropped, the tick before took longer than an interval
+                uint32_t mean_late_us;
+                uint32_t p99_late_us;
+                uint32_t max_late_us;
+                uint32_t p99_jitter_us;
+                uint32_t max_jitter_us;
+        };
+
+    protected:
+
+        static const EventBits_t timer_bit = 1 << 0;
+
+        esp_timer_handle_t timer;
+        StaticEventGroup_t events_buffer;
+        EventGroupHandle_t events; // timer_bit: the timer expired
+        int64_t deadline_us_; // of the current tick
+        int64_t next_tick_us_; // deadline of the next tick
+        int64_t interval_us; // from the current to the next tick
+        int64_t last_tick_us; // start of the last tick (0: none)
+        int64_t last_interval_us;
+
+        Histogram lateness_us; // of the current window
+        Histogram jitter_us;
+        uint32_t late;
+        uint32_t missed;
+
+        static void timer_callback(void* args);
+
+        void close_window();
+
+    public:
+
+        Summary last; // of the last complete window
+        uint32_t windows;
+
+    public:
+
+        TickScheduler();
+
+        // Create the timer and its event group
+        bool begin();
+
+        // First tick at now_us (e.g. at the start of a round)
+        void start(const int64_t now_us);
+
+        // Deadline of the current tick and of the next one
+        int64_t deadline_us() const { return this->deadline_us_; }
+        int64_t next_tick_us() const { return this->next_tick_us_; }
+
+        // Block until wake_us (at the latest until the next tick)
+        void wait_until(const int64_t wake_us);
+
+        // The next tick started at now_us, returns its lateness
+        int64_t tick(const int64_t now_us);
+
+        // After a tick: the next one is due Interval_us after the deadline of this one
+        void schedule_next(const int64_t Interval_us);
+
+        // Summary of the current (incomplete) window
+        Summary current() const;
+
+        // Print the last complete window and the current one as one line of JSON
+        void print_json() const;
+};
+
+}; // namespace Game
@@ -0,0 +1,47 @@
+#include <Arduino.h>
+
+#include "Stick.h"
+
+namespace Game {
+using namespace StickOctant;
+
+
+// Direction of octant in the quadrant of (x, y), y > 0 is up
+static Direction octant_direction(const uint8_t octant, const int32_t x, const int32_t y) {
+    const int32_t sign_x = (x < 0) ? -1 : 1;
+    const int32_t sign_y = (y < 0) ? 1 : -1;
+    return Direction((octant != Y) ? sign_x : 0, (octant != X) ? sign_y : 0);
+}
+
+static uint8_t octant_entry(const int32_t x, const int32_t y) {
+    const int32_t a = (x < 0) ? ((-x < size) ? -x : size - 1) : ((x < size) ? x : size - 1);
+    const int32_t b = (y < 0) ? ((-y < size) ? -y : size - 1) : ((y < size) ? y : size - 1);
+    return OctantTable::entries[a + (b * size)];
+}
+
+Direction AnalogStick::octant(const int32_t x, const int32_t y) {
+    return octant_direction(octant_entry(x, y) & octant_mask, x, y);
+}
+
+Direction AnalogStick::update(const int32_t x, const int32_t y, const uint32_t magnitude_threshold) {
+
+    // deadzone
+    const int32_t threshold = (int32_t) magnitude_threshold + ((this->last == Direction::None) ? deadzone_hysteresis : -deadzone_hysteresis);
+    if (threshold > 0 && (x * x) + (y * y) < threshold * threshold) {
+        this->last = Direction::None;
+        return Direction::None;
+    }
+
+    // octant, keep the last one if it is on the other side of a close boundary
+    const uint8_t entry = octant_entry(x, y);
+    Direction dir = octant_direction(entry & octant_mask, x, y);
+    if (entry & band) {
+        const Direction other = octant_direction(entry >> neighbour_shift, x, y);
+        if (other == this->last) { dir = other; }
+    }
+
+    this->last = dir;
+    return dir;
+}
+
+}; // namespace Game
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "stdint.h"
+#include "Game.h"
+
+namespace Game {
+
+// Compile time list of table indices (built by halving, so the template depth stays at log2(N))
+template <int32_t... I> struct Indices {};
+
+template <typename A, typename B> struct ConcatIndices;
+template <int32_t... A, int32_t... B> struct ConcatIndices<Indices<A...>, Indices<B...>> {
+    typedef Indices<A..., (int32_t)(sizeof...(A) + B)...> type;
+};
+
+template <int32_t N> struct MakeIndices {
+    typedef typename ConcatIndices<typename MakeIndices<N / 2>::type, typename MakeIndices<N - (N / 2)>::type>::type type;
+};
+template <> struct MakeIndices<0> { typedef Indices<> type; };
+template <> struct MakeIndices<1> { typedef Indices<0> type; };
+
+/* Octant of an analog stick position, one table entry per (|x|, |y|), the other quadrants are mirrored.
+ * A position is along x if |y| <= comp(|x|), along y if |x| <= comp(|y|) and diagonal otherwise,
+ * with comp(v) = v * tan(22.5 deg) as before, so looking up a direction is a single load.
+ * Entries closer than hysteresis_degrees to an octant boundary are flagged together with the octant
+ * on the other side, the stick keeps pointing there if it did so before (no jitter at the boundaries).
+ */
+namespace StickOctant {
+
+    enum Octant : uint8_t {
+        X = 0, // left or right
+        Diagonal = 1,
+        Y = 2, // up or down
+    };
+
+    static const int32_t size = 129; // |x|, |y| in [0, 128]
+    static const uint8_t octant_mask = 0x3;
+    static const uint8_t band = 0x4; // close to a boundary
+    static const int32_t neighbour_shift = 3; // octant on the other side of the boundary
+
+    // hysteresis_degrees = 5: sin(22.5 deg), cos(22.5 deg) and sin(5 deg)^2
+    constexpr double sin_boundary = 0.38268343236508978;
+    constexpr double cos_boundary = 0.92387953251128674;
+    constexpr double sin2_hysteresis = 0.0075961234938959;
+
+    constexpr int32_t comp(const int32_t value) { return (int32_t)(((int64_t)value * 16777216LL) / 40503782LL); }
+
+    constexpr Octant octant(const int32_t a, const int32_t b) {
+        return (b <= comp(a)) ? X : ((a <= comp(b)) ? Y : Diagonal);
+    }
+
+    // squared distances to the boundaries at 22.5 and 67.5 degrees
+    constexpr double distance2_x(const int32_t a, const int32_t b) { return (b * cos_boundary - a * sin_boundary) * (b * cos_boundary - a * sin_boundary); }
+    constexpr double distance2_y(const int32_t a, const int32_t b) { return (b * sin_boundary - a * cos_boundary) * (b * sin_boundary - a * cos_boundary); }
+
+    constexpr uint8_t neighbour(const int32_t a, const int32_t b) {
+        return (octant(a, b) != Diagonal) ? Diagonal : ((distance2_x(a, b) < distance2_y(a, b)) ? X : Y);
+    }
+
+    constexpr bool in_band(const int32_t a, const int32_t b) {
+        return ((distance2_x(a, b) < distance2_y(a, b)) ? distance2_x(a, b) : distance2_y(a, b)) < (a * a + b * b) * sin2_hysteresis;
+    }
+
+    constexpr uint8_t entry(const int32_t a, const int32_t b) {
+        return octant(a, b) | (in_band(a, b) ? band : 0) | (neighbour(a, b) << neighbour_shift);
+    }
+
+    template <typename> struct Table;
+    template <int32_t... I> struct Table<Indices<I...>> {
+        static constexpr uint8_t entries[sizeof...(I)] = { entry(I % size, I / size)... };
+    };
+    template <int32_t... I> constexpr uint8_t Table<Indices<I...>>::entries[sizeof...(I)];
+
+    // entry of (|x|, |y|) is entries[|x| + |y| * size]
+    typedef Table<MakeIndices<size * size>::type> OctantTable;
+
+}; // namespace StickOctant
+
+/* Direction of one analog stick with a deadzone, the stick has to be pushed deadzone_hysteresis further
+ * to leave the deadzone than to stay out of it. Not thread safe, keeps the last direction.
+ */
+class AnalogStick {
+
+    public:
+
+        static const int32_t deadzone_hysteresis = 8;
+
+        Direction last;
+
+    public:
+
+        AnalogStick(): last(0, 0) {}
+
+        // Direction of the octant (x, y) is in, without deadzone and hysteresis (y > 0 is up)
+        static Direction octant(const int32_t x, const int32_t y);
+
+        // Direction of the stick at (x, y), None inside the deadzone
+        Direction update(const int32_t x, const int32_t y, const uint32_t magnitude_threshold);
+
+        void reset() { this->last = Direction(0, 0); }
+};
+
+}; // namespace Game
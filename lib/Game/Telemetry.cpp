@@ -0,0 +1,133 @@
+#include <Arduino.h>
+
+#include "Telemetry.h"
+#include "GameLog.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include <algorithm>
+#include <new>
+#include <stdlib.h>
+
+namespace Game {
+
+std::atomic<uint32_t> AllocationCounters::allocations(0);
+std::atomic<uint32_t> AllocationCounters::bytes(0);
+std::atomic<uint32_t> AllocationCounters::frees(0);
+std::atomic<uint32_t> AllocationCounters::task_allocations(0);
+std::atomic<uint32_t> AllocationCounters::task_bytes(0);
+TaskHandle_t AllocationCounters::tracked_task = nullptr;
+
+}; // namespace Game
+
+
+// Replacements of the global operator new and delete, they count every allocation (malloc still works as before)
+
+static void* counted_malloc(const size_t size) {
+    Game::AllocationCounters::count(size);
+    return malloc((size > 0) ? size : 1);
+}
+
+static void counted_free(void* ptr) {
+    if (ptr == nullptr) { return; }
+    Game::AllocationCounters::frees.fetch_add(1, std::memory_order_relaxed);
+    free(ptr);
+}
+
+void* operator new(size_t size) {
+    void* ptr = counted_malloc(size);
+    if (ptr == nullptr) { abort(); }
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    void* ptr = counted_malloc(size);
+    if (ptr == nullptr) { abort(); }
+    return ptr;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return counted_malloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return counted_malloc(size); }
+
+void operator delete(void* ptr) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { counted_free(ptr); }
+
+
+namespace Game {
+
+HeapTelemetry::HeapTelemetry(): task(nullptr), tick_allocations(0), tick_bytes(0), report_all_allocations(0), next_report_us(0), sealed(false), setup_allocations(0) {
+    this->current = Report{0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+    this->last = this->current;
+}
+
+void HeapTelemetry::begin() {
+    this->task = xTaskGetCurrentTaskHandle();
+    AllocationCounters::tracked_task = this->task;
+    this->report_all_allocations = AllocationCounters::allocations.load(std::memory_order_relaxed);
+    this->next_report_us = esp_timer_get_time() + report_interval_us;
+}
+
+void HeapTelemetry::seal() {
+    this->setup_allocations = AllocationCounters::task_allocations.load(std::memory_order_relaxed);
+    this->sealed = true;
+}
+
+uint32_t HeapTelemetry::allocations_after_setup() const {
+    return this->sealed ? (AllocationCounters::task_allocations.load(std::memory_order_relaxed) - this->setup_allocations) : 0;
+}
+
+void HeapTelemetry::start_tick() {
+    this->tick_allocations = AllocationCounters::task_allocations.load(std::memory_order_relaxed);
+    this->tick_bytes = AllocationCounters::task_bytes.load(std::memory_order_relaxed);
+}
+
+void HeapTelemetry::sample() {
+    this->current.free_heap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    this->current.min_free_heap = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    this->current.largest_free_block = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    this->current.stack_free = uxTaskGetStackHighWaterMark(this->task); // bytes on the ESP32
+    this->current.all_allocations = AllocationCounters::allocations.load(std::memory_order_relaxed) - this->report_all_allocations;
+}
+
+uint32_t HeapTelemetry::end_tick(const int64_t now_us) {
+
+    const uint32_t allocations = AllocationCounters::task_allocations.load(std::memory_order_relaxed) - this->tick_allocations;
+    const uint32_t bytes = AllocationCounters::task_bytes.load(std::memory_order_relaxed) - this->tick_bytes;
+
+    Report& report = this->current;
+    report.ticks += 1;
+    if (allocations > 0) { report.ticks_with_allocations += 1; }
+    report.allocations += allocations;
+    report.bytes += bytes;
+    report.max_tick_allocations = std::max(report.max_tick_allocations, allocations);
+    report.max_tick_bytes = std::max(report.max_tick_bytes, bytes);
+    if (this->sealed && allocations > 0) { GAME_LOG_WARN("heap: %u allocations (%u bytes) in a tick after setup", allocations, bytes); }
+
+    if (now_us >= this->next_report_us) {
+        this->sample();
+        this->last = report;
+        GAME_LOG_INFO("heap: free %u, min free %u, largest block %u bytes", report.free_heap, report.min_free_heap, report.largest_free_block);
+        GAME_LOG_INFO("stack: %u bytes never used by the game task", report.stack_free);
+        GAME_LOG_INFO("alloc (new only): %u in %u of %u ticks, max %u per tick", report.allocations, report.ticks_with_allocations, report.ticks, report.max_tick_allocations);
+        GAME_LOG_INFO("alloc (new only): %u bytes, max %u per tick, %u by all tasks", report.bytes, report.max_tick_bytes, report.all_allocations);
+        this->current = Report{0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+        this->report_all_allocations = AllocationCounters::allocations.load(std::memory_order_relaxed);
+        this->next_report_us = now_us + report_interval_us;
+    }
+    return allocations;
+}
+
+void HeapTelemetry::print_json() {
+
+    this->sample();
+    const Report& report = this->current;
+    printf("{\"telemetry\":{\"free_heap\":%u,\"min_free_heap\":%u,\"largest_free_block\":%u,\"stack_free\":%u,"
+        "\"ticks\":%u,\"ticks_with_allocations\":%u,\"allocations\":%u,\"bytes\":%u,\"max_tick_allocations\":%u,\"max_tick_bytes\":%u,"
+        "\"all_allocations\":%u,\"frees\":%u,\"after_setup\":%u,\"counted\":\"operator_new\"}}\n",
+        report.free_heap, report.min_free_heap, report.largest_free_block, report.stack_free,
+        report.ticks, report.ticks_with_allocations, report.allocations, report.bytes, report.max_tick_allocations, report.max_tick_bytes,
+        report.all_allocations, AllocationCounters::frees.load(std::memory_order_relaxed), this->allocations_after_setup());
+}
+
+}; // namespace Game
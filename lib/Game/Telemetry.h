@@ -0,0 +1,103 @@
+#pragma once
+
+#include "stdint.h"
+#include <stddef.h>
+#include <atomic>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+namespace Game {
+
+/* Allocations through operator new (the global operator new and delete are replaced in Telemetry.cpp),
+ * in total and of the tracked task. The counters wrap around, only differences are meaningful.
+ * Calls of malloc(), heap_caps_malloc() and osi_malloc() (e.g. the Bluetooth stack and the PS4 output reports)
+ * don't go through operator new and aren't counted.
+ */
+class AllocationCounters {
+
+    public:
+
+        static std::atomic<uint32_t> allocations;
+        static std::atomic<uint32_t> bytes;
+        static std::atomic<uint32_t> frees;
+        static std::atomic<uint32_t> task_allocations; // of tracked_task
+        static std::atomic<uint32_t> task_bytes;
+        static TaskHandle_t tracked_task;
+
+        static void count(const size_t size) {
+            allocations.fetch_add(1, std::memory_order_relaxed);
+            bytes.fetch_add((uint32_t) size, std::memory_order_relaxed);
+            if (tracked_task != nullptr && xTaskGetCurrentTaskHandle() == tracked_task) {
+                task_allocations.fetch_add(1, std::memory_order_relaxed);
+                task_bytes.fetch_add((uint32_t) size, std::memory_order_relaxed);
+            }
+        }
+};
+
+/* Heap and stack usage of the game task, checked once per tick and reported every report_interval_us:
+ * allocations and bytes per tick of the game task, free heap, minimum free heap since boot,
+ * largest free block (fragmentation) and the stack high water mark of the task.
+ * The allocations are those of AllocationCounters (operator new only, malloc() isn't counted),
+ * the free heap covers all allocations.
+ */
+class HeapTelemetry {
+
+    public:
+
+        static const int64_t report_interval_us = 10000000;
+
+        class Report {
+            public:
+                uint32_t free_heap;
+                uint32_t min_free_heap;
+                uint32_t largest_free_block;
+                uint32_t stack_free; // bytes of the game task stack which were never used
+                uint32_t ticks;
+                uint32_t ticks_with_allocations;
+                uint32_t allocations; // of the game task during the ticks
+                uint32_t bytes;
+                uint32_t max_tick_allocations;
+                uint32_t max_tick_bytes;
+                uint32_t all_allocations; // of all tasks since the last report
+        };
+
+    protected:
+
+        TaskHandle_t task;
+        uint32_t tick_allocations;
+        uint32_t tick_bytes;
+        uint32_t report_all_allocations;
+        int64_t next_report_us;
+        bool sealed;
+        uint32_t setup_allocations; // of the game task when seal() was called
+        Report current;
+
+        void sample();
+
+    public:
+
+        Report last; // of the last report interval
+
+    public:
+
+        HeapTelemetry();
+
+        // Count the allocations of the calling task from now on
+        void begin();
+
+        // Setup is done, from now on the game task shouldn't allocate heap memory (ticks which do are logged)
+        void seal();
+
+        // Allocations of the game task since seal() (0 unless something allocates after setup)
+        uint32_t allocations_after_setup() const;
+
+        void start_tick();
+
+        // Allocations since start_tick() (of the game task), the report is logged if it is due
+        uint32_t end_tick(const int64_t now_us);
+
+        // Print the current interval as one line of JSON
+        void print_json();
+};
+
+}; // namespace Game
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "stdint.h"
+
+namespace Game {
+
+/* Hashed timer wheel keyed by game tick: a timer which expires at tick t is kept in slot t % Slots.
+ * schedule() and cancel() are O(1), advance() only visits the timers of one slot, so a tick costs O(1)
+ * however many timers are pending (as long as they spread over the slots). Timers further away than Slots ticks
+ * stay in their slot until their tick comes round. Up to Capacity timers, all storage is part of the object.
+ */
+template <typename T, int32_t Capacity, int32_t Slots = 64>
+class TimerWheel {
+
+    public:
+
+        // index + 1 in the low 16 bits, generation of the entry in the high 16 bits (handles of expired timers don't match)
+        typedef uint32_t Handle;
+        static const Handle None = 0;
+        static const int32_t capacity = Capacity;
+        static const int32_t slots = Slots;
+
+    protected:
+
+        static const int16_t end = -1;
+
+        class Entry {
+            public:
+                uint32_t expiry; // tick
+                uint16_t generation;
+                int16_t next; // in its slot or in the free list
+                int16_t prev;
+                bool active;
+                bool due; // in the list of the timers which expire in the current advance()
+                T value;
+        };
+
+        Entry entries[Capacity];
+        int16_t heads[Slots];
+        int16_t due_head; // timers which expire in the current advance()
+        int16_t free_head;
+        int32_t count;
+        uint32_t tick_;
+
+        static int32_t slot(const uint32_t tick) { return tick % Slots; }
+
+        int32_t index(const Handle handle) const {
+            const int32_t i = (int32_t)(handle & 0xFFFF) - 1;
+            if (i < 0 || i >= Capacity) { return end; }
+            const Entry& entry = this->entries[i];
+            return (entry.active && entry.generation == (handle >> 16)) ? i : end;
+        }
+
+        void unlink(const int32_t i) {
+            Entry& entry = this->entries[i];
+            if (entry.prev != end) { this->entries[entry.prev].next = entry.next; }
+            else if (entry.due) { this->due_head = entry.next; }
+            else { this->heads[slot(entry.expiry)] = entry.next; }
+            if (entry.next != end) { this->entries[entry.next].prev = entry.prev; }
+        }
+
+        // put entry i in front of the list head
+        void link(const int32_t i, int16_t& head) {
+            Entry& entry = this->entries[i];
+            entry.prev = end;
+            entry.next = head;
+            if (entry.next != end) { this->entries[entry.next].prev = i; }
+            head = i;
+        }
+
+        void release(const int32_t i) {
+            Entry& entry = this->entries[i];
+            entry.active = false;
+            entry.generation += 1;
+            entry.next = this->free_head;
+            this->free_head = i;
+            this->count -= 1;
+        }
+
+    public:
+
+        TimerWheel() {
+            for (auto& entry : this->entries) { entry.generation = 0; }
+            this->clear();
+        }
+
+        // Remove all timers and start at tick 0 (handles of the removed timers don't match new ones)
+        void clear() {
+            for (auto& head : this->heads) { head = end; }
+            this->due_head = end;
+            for (int32_t i = 0; i < Capacity; ++i) {
+                if (this->entries[i].active) { this->entries[i].generation += 1; }
+                this->entries[i].active = false;
+                this->entries[i].next = (i + 1 < Capacity) ? (i + 1) : end;
+            }
+            this->free_head = (Capacity > 0) ? 0 : end;
+            this->count = 0;
+            this->tick_ = 0;
+        }
+
+        int32_t size() const { return this->count; }
+        uint32_t tick() const { return this->tick_; }
+
+        // Timer which expires delay ticks from now (at least 1) with value, None if the wheel is full
+        Handle schedule(const uint32_t delay, const T& value) {
+            if (this->free_head == end) { return None; }
+            const int32_t i = this->free_head;
+            Entry& entry = this->entries[i];
+            this->free_head = entry.next;
+            entry.expiry = this->tick_ + ((delay > 0) ? delay : 1);
+            entry.active = true;
+            entry.due = false;
+            entry.value = value;
+            this->link(i, this->heads[slot(entry.expiry)]);
+            this->count += 1;
+            return ((Handle) entry.generation << 16) | (Handle)(i + 1);
+        }
+
+        // Remove a pending timer, false if it already expired or was cancelled
+        bool cancel(const Handle handle) {
+            const int32_t i = this->index(handle);
+            if (i == end) { return false; }
+            this->unlink(i);
+            this->release(i);
+            return true;
+        }
+
+        bool pending(const Handle handle) const { return this->index(handle) != end; }
+
+        // Ticks until the timer expires (0 if it isn't pending)
+        uint32_t remaining(const Handle handle) const {
+            const int32_t i = this->index(handle);
+            return (i == end) ? 0 : (this->entries[i].expiry - this->tick_);
+        }
+
+        /* Next tick: expire(value) is called for every timer which expires now, returns their number.
+         * The slot is detached and walked once: timers which expire in a later round go back into it, the others
+         * are fired from the due list, so a tick costs O(timers in the slot). expire may schedule and cancel timers
+         * (also the ones which are still due in this tick).
+         */
+        template <typename Callback>
+        int32_t advance(Callback expire) {
+            this->tick_ += 1;
+            // the slot keeps its order (newest first), the due list turns it round (oldest first)
+            int16_t& head = this->heads[slot(this->tick_)];
+            int32_t i = head;
+            int32_t tail = end;
+            head = end;
+            while (i != end) {
+                Entry& entry = this->entries[i];
+                const int32_t next = entry.next;
+                entry.due = (entry.expiry == this->tick_);
+                if (entry.due) { this->link(i, this->due_head); }
+                else {
+                    entry.prev = tail;
+                    entry.next = end;
+                    if (tail != end) { this->entries[tail].next = i; }
+                    else { head = i; }
+                    tail = i;
+                }
+                i = next;
+            }
+
+            int32_t expired = 0;
+            while (this->due_head != end) {
+                const int32_t due = this->due_head;
+                const T value = this->entries[due].value;
+                this->unlink(due);
+                this->release(due);
+                expire(value);
+                expired += 1;
+            }
+            return expired;
+        }
+};
+
+}; // namespace Game
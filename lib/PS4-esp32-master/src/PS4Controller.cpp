@@ -109,6 +109,20 @@ void PS4Controller::sendToController()
 
 
 
+uint32_t PS4Controller::read(ps4_t& data, ps4_event_t* event) const
+{
+    return ps4ReadState(&data, event);
+}
+
+
+ps4_t PS4Controller::state() const
+{
+    ps4_t data;
+    ps4ReadState(&data, nullptr);
+    return data;
+}
+
+
 void PS4Controller::attach(callback_t callback)
 {
     _callback_event = callback;
@@ -116,6 +130,13 @@ void PS4Controller::attach(callback_t callback)
 }
 
 
+void PS4Controller::attach(packet_callback_t callback)
+{
+    _callback_packet = callback;
+
+}
+
+
 void PS4Controller::attachOnConnect(callback_t callback)
 {
     _callback_connect = callback;
@@ -129,14 +150,18 @@ void PS4Controller::attachOnDisconnect(callback_t callback)
 }
 
 
-void PS4Controller::_event_callback(void *object, ps4_t data, ps4_event_t event)
+void PS4Controller::_event_callback(void *object, const ps4_t *data, const ps4_event_t *event)
 {
     PS4Controller* This = (PS4Controller*) object;
 
-    memcpy(&This->data, &data, sizeof(ps4_t));
-    memcpy(&This->event, &event, sizeof(ps4_event_t));
+    if (This->_callback_packet){
+        This->_callback_packet(*data, *event);
+    }
 
+    // callbacks without arguments read PS4.data and PS4.event
     if (This->_callback_event){
+        memcpy(&This->data, data, sizeof(ps4_t));
+        memcpy(&This->event, event, sizeof(ps4_event_t));
         This->_callback_event();
     }
 }
@@ -14,7 +14,9 @@ class PS4Controller
 {
     public:
         typedef void(*callback_t)();
+        typedef void(*packet_callback_t)(const ps4_t& data, const ps4_event_t& event);
 
+        // only updated for callbacks attached with attach(callback_t), use read() or state() instead
         ps4_t data;
         ps4_event_t event;
         ps4_cmd_t output;
@@ -33,15 +35,21 @@ class PS4Controller
 
         void sendToController();
 
+        // consistent copy of the last packet (and its events), from any task, returns the number of packets
+        uint32_t read(ps4_t& data, ps4_event_t* event = nullptr) const;
+        ps4_t state() const;
+
         void attach(callback_t callback);
+        void attach(packet_callback_t callback); // called in the bluetooth task, without copying the packet
         void attachOnConnect(callback_t callback);
         void attachOnDisconnect(callback_t callback);
 
     private:
-        static void _event_callback(void *object, ps4_t data, ps4_event_t event);
+        static void _event_callback(void *object, const ps4_t *data, const ps4_event_t *event);
         static void _connection_callback(void *object, uint8_t is_connected);
 
         callback_t _callback_event = nullptr;
+        packet_callback_t _callback_packet = nullptr;
         callback_t _callback_connect = nullptr;
         callback_t _callback_disconnect = nullptr;
 
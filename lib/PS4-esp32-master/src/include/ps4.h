@@ -32,36 +32,78 @@ typedef struct {
 /*   B U T T O N S   */
 /*********************/
 
-typedef struct {
-    uint8_t options  : 1;
-	uint8_t l3       : 1;
-	uint8_t r3       : 1;
-    uint8_t share    : 1;
-
-    uint8_t up       : 1;
-    uint8_t right    : 1;
-    uint8_t down     : 1;
-    uint8_t left     : 1;
-
-    uint8_t upright  : 1;
-    uint8_t upleft   : 1;
-    uint8_t downright: 1;
-    uint8_t downleft : 1;
-
-    uint8_t l2       : 1;
-    uint8_t r2       : 1;
-    uint8_t l1       : 1;
-    uint8_t r1       : 1;
-
-    uint8_t triangle : 1;
-    uint8_t circle   : 1;
-    uint8_t cross    : 1;
-    uint8_t square   : 1;
-
-    uint8_t ps       : 1;
-    uint8_t touchpad : 1;
+/* Bits of ps4_button_t.mask, the bits of the raw HID report are kept at their place
+ * (the d-pad is sent as a 4 bit hat value and spread over the up ... downleft bits)
+ */
+enum ps4_button_mask {
+    ps4_button_mask_up        = 1 << 0,
+    ps4_button_mask_right     = 1 << 1,
+    ps4_button_mask_down      = 1 << 2,
+    ps4_button_mask_left      = 1 << 3,
+
+    ps4_button_mask_square    = 1 << 4,
+    ps4_button_mask_cross     = 1 << 5,
+    ps4_button_mask_circle    = 1 << 6,
+    ps4_button_mask_triangle  = 1 << 7,
+
+    ps4_button_mask_l1        = 1 << 8,
+    ps4_button_mask_r1        = 1 << 9,
+    ps4_button_mask_l2        = 1 << 10,
+    ps4_button_mask_r2        = 1 << 11,
+
+    ps4_button_mask_share     = 1 << 12,
+    ps4_button_mask_options   = 1 << 13,
+    ps4_button_mask_l3        = 1 << 14,
+    ps4_button_mask_r3        = 1 << 15,
+
+    ps4_button_mask_ps        = 1 << 16,
+    ps4_button_mask_touchpad  = 1 << 17,
+    ps4_button_mask_upright   = 1 << 18,
+    ps4_button_mask_upleft    = 1 << 19,
+    ps4_button_mask_downright = 1 << 20,
+    ps4_button_mask_downleft  = 1 << 21,
+
+    ps4_button_mask_arrows    = ps4_button_mask_up | ps4_button_mask_right | ps4_button_mask_down | ps4_button_mask_left |
+                                ps4_button_mask_upright | ps4_button_mask_upleft | ps4_button_mask_downright | ps4_button_mask_downleft
+};
+
+/* All buttons as one mask, the single buttons are still accessible by name (bit n of mask is the n-th field) */
+typedef union {
+    struct {
+        uint8_t up       : 1;
+        uint8_t right    : 1;
+        uint8_t down     : 1;
+        uint8_t left     : 1;
+
+        uint8_t square   : 1;
+        uint8_t cross    : 1;
+        uint8_t circle   : 1;
+        uint8_t triangle : 1;
+
+        uint8_t l1       : 1;
+        uint8_t r1       : 1;
+        uint8_t l2       : 1;
+        uint8_t r2       : 1;
+
+        uint8_t share    : 1;
+        uint8_t options  : 1;
+        uint8_t l3       : 1;
+        uint8_t r3       : 1;
+
+        uint8_t ps       : 1;
+        uint8_t touchpad : 1;
+        uint8_t upright  : 1;
+        uint8_t upleft   : 1;
+
+        uint8_t downright: 1;
+        uint8_t downleft : 1;
+    };
+    uint32_t mask;
 } ps4_button_t;
 
+/* true if any of the buttons in mask (ps4_button_mask bits) is set */
+static inline bool ps4_button_any( ps4_button_t button, uint32_t mask ) { return (button.mask & mask) != 0; }
+
 
 /*******************************/
 /*   S T A T U S   F L A G S   */
@@ -118,6 +160,7 @@ typedef struct {
     ps4_button_t button;
     ps4_status_t status;
     ps4_sensor_t sensor;
+    int64_t timestamp_us; // esp_timer_get_time() when the packet was parsed
 } ps4_t;
 
 
@@ -128,8 +171,9 @@ typedef struct {
 typedef void(*ps4_connection_callback_t)( uint8_t is_connected );
 typedef void(*ps4_connection_object_callback_t)( void *object, uint8_t is_connected );
 
-typedef void(*ps4_event_callback_t)( ps4_t ps4, ps4_event_t event );
-typedef void(*ps4_event_object_callback_t)( void *object, ps4_t ps4, ps4_event_t event );
+/* ps4 and event point into the parser's buffers and are only valid during the callback */
+typedef void(*ps4_event_callback_t)( const ps4_t *ps4, const ps4_event_t *event );
+typedef void(*ps4_event_object_callback_t)( void *object, const ps4_t *ps4, const ps4_event_t *event );
 
 
 /********************************************************************************/
@@ -147,6 +191,7 @@ void ps4SetEventObjectCallback( void *object, ps4_event_object_callback_t cb );
 void ps4SetLed( uint8_t r, uint8_t g, uint8_t b );
 void ps4SetOutput( ps4_cmd_t prev_cmd );
 void ps4SetBluetoothMacAddress( const uint8_t *mac );
+uint32_t ps4ReadState( ps4_t *state, ps4_event_t *event );
 
 
 #endif
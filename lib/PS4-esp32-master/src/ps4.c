@@ -4,6 +4,8 @@
 #include <esp_system.h>
 #include "include/ps4.h"
 #include "ps4_int.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
 
 /********************************************************************************/
 /*                              C O N S T A N T S                               */
@@ -26,6 +28,28 @@ static ps4_event_object_callback_t ps4_event_object_cb = NULL;
 static void *ps4_event_object = NULL;
 
 
+/* Output reports: the last command of ps4SetOutput() waits in pending until the minimum interval
+ * since the last report is over and the channel isn't congested, so at most one report is in flight
+ */
+static portMUX_TYPE ps4_output_lock = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t ps4_output_timer = NULL;
+static ps4_cmd_t ps4_output_pending;
+static ps4_cmd_t ps4_output_sent;
+static bool ps4_output_has_pending = false;
+static bool ps4_output_has_sent = false; // the controller shows ps4_output_sent
+static bool ps4_output_timer_armed = false;
+static int64_t ps4_output_sent_us = 0;
+
+
+/********************************************************************************/
+/*              L O C A L    F U N C T I O N     P R O T O T Y P E S            */
+/********************************************************************************/
+
+static bool ps4_send_cmd( ps4_cmd_t cmd );
+static void ps4_output_timer_callback( void *arg );
+static void ps4_output_retry( void );
+
+
 /********************************************************************************/
 /*                      P U B L I C    F U N C T I O N S                        */
 /********************************************************************************/
@@ -43,6 +67,11 @@ static void *ps4_event_object = NULL;
 *******************************************************************************/
 void ps4Init()
 {
+    if (ps4_output_timer == NULL) {
+        const esp_timer_create_args_t timer_args = { .callback = ps4_output_timer_callback, .name = "ps4_output" };
+        esp_timer_create(&timer_args, &ps4_output_timer);
+    }
+
     ps4_spp_init();
     ps4_gap_init_services();
 }
@@ -102,23 +131,7 @@ void ps4Enable()
 *******************************************************************************/
 void ps4Cmd( ps4_cmd_t cmd )
 {
-    hid_cmd_t hid_cmd = { .data = {0x80, 0x00, 0xFF} };
-    uint16_t len = sizeof(hid_cmd.data);
-
-    hid_cmd.code = hid_cmd_code_set_report | hid_cmd_code_type_output;
-    hid_cmd.identifier = hid_cmd_identifier_ps4_control;
-
-    hid_cmd.data[ps4_control_packet_index_small_rumble] = cmd.smallRumble; // Small Rumble
-    hid_cmd.data[ps4_control_packet_index_large_rumble] = cmd.largeRumble; // Big rumble
-
-    hid_cmd.data[ps4_control_packet_index_red] = cmd.r; // Red
-    hid_cmd.data[ps4_control_packet_index_green] = cmd.g; // Green
-    hid_cmd.data[ps4_control_packet_index_blue] = cmd.b; // Blue
-
-    hid_cmd.data[ps4_control_packet_index_flash_on_time] = cmd.flashOn; // Time to flash bright (255 = 2.5 seconds)
-    hid_cmd.data[ps4_control_packet_index_flash_off_time] = cmd.flashOff; // Time to flash dark (255 = 2.5 seconds)
-
-    ps4_gap_send_hid( &hid_cmd, len );
+    ps4_send_cmd( cmd );
 }
 
 
@@ -148,7 +161,10 @@ void ps4SetLed(uint8_t r, uint8_t g, uint8_t b)
 **
 ** Function         ps4SetOutput
 **
-** Description      Sets feedback on the PS4 controller.
+** Description      Sets feedback on the PS4 controller. Updates within
+**                  PS4_OUTPUT_MIN_INTERVAL_US of the last report are merged
+**                  (the last one wins) and sent by a timer, updates which
+**                  the controller already shows aren't sent at all.
 **
 **
 ** Returns          void
@@ -156,7 +172,12 @@ void ps4SetLed(uint8_t r, uint8_t g, uint8_t b)
 *******************************************************************************/
 void ps4SetOutput(ps4_cmd_t prev_cmd)
 {
-    ps4Cmd(prev_cmd);
+    portENTER_CRITICAL(&ps4_output_lock);
+    ps4_output_pending = prev_cmd;
+    ps4_output_has_pending = true;
+    portEXIT_CRITICAL(&ps4_output_lock);
+
+    ps4_output_flush();
 }
 
 
@@ -254,8 +275,18 @@ void ps4SetBluetoothMacAddress( const uint8_t *mac )
 
 void ps4_connect_event( uint8_t is_connected )
 {
+    // a new connection starts with the default lightbar, send the last output again
+    portENTER_CRITICAL(&ps4_output_lock);
+    if (ps4_output_has_sent && !ps4_output_has_pending) {
+        ps4_output_pending = ps4_output_sent;
+        ps4_output_has_pending = true;
+    }
+    ps4_output_has_sent = false;
+    portEXIT_CRITICAL(&ps4_output_lock);
+
     if(is_connected){
        ps4Enable();
+       ps4_output_flush();
     }
 
     if(ps4_connection_cb != NULL)
@@ -270,7 +301,7 @@ void ps4_connect_event( uint8_t is_connected )
 }
 
 
-void ps4_packet_event( ps4_t ps4, ps4_event_t event )
+void ps4_packet_event( const ps4_t *ps4, const ps4_event_t *event )
 {
     if(ps4_event_cb != NULL)
     {
@@ -282,3 +313,129 @@ void ps4_packet_event( ps4_t ps4, ps4_event_t event )
         ps4_event_object_cb( ps4_event_object, ps4, event );
     }
 }
+
+
+/*******************************************************************************
+**
+** Function         ps4_output_flush
+**
+** Description      Sends the pending output report if the minimum interval
+**                  is over, else arms the output timer to send it then.
+**                  Nothing is sent while the HID channel is congested or
+**                  when the write fails, the output timer then tries again
+**                  after the minimum interval.
+**
+**
+** Returns          void
+**
+*******************************************************************************/
+void ps4_output_flush()
+{
+    ps4_cmd_t cmd;
+    int64_t wait_us = 0;
+    bool send = false;
+    bool arm = false;
+
+    if (!ps4_gap_is_connected()) {
+        return;
+    }
+
+    if (ps4_gap_is_congested()) {
+        ps4_output_retry();
+        return;
+    }
+
+    const int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&ps4_output_lock);
+    if (ps4_output_has_pending) {
+        if (ps4_output_has_sent && memcmp(&ps4_output_pending, &ps4_output_sent, sizeof(ps4_cmd_t)) == 0) {
+            ps4_output_has_pending = false;
+        }
+        else {
+            wait_us = ps4_output_sent_us + PS4_OUTPUT_MIN_INTERVAL_US - now;
+            if (wait_us <= 0) {
+                cmd = ps4_output_pending;
+                ps4_output_sent = cmd;
+                ps4_output_has_sent = true;
+                ps4_output_has_pending = false;
+                ps4_output_sent_us = now;
+                send = true;
+            }
+            else if (!ps4_output_timer_armed && ps4_output_timer != NULL) {
+                ps4_output_timer_armed = true;
+                arm = true;
+            }
+        }
+    }
+    portEXIT_CRITICAL(&ps4_output_lock);
+
+    if (arm) {
+        esp_timer_start_once(ps4_output_timer, wait_us);
+    }
+
+    if (send && !ps4_send_cmd(cmd)) {
+        // not sent, try again with the next update
+        portENTER_CRITICAL(&ps4_output_lock);
+        if (!ps4_output_has_pending) {
+            ps4_output_pending = cmd;
+            ps4_output_has_pending = true;
+        }
+        ps4_output_has_sent = false;
+        portEXIT_CRITICAL(&ps4_output_lock);
+
+        ps4_output_retry();
+    }
+}
+
+
+/* Arms the output timer with the minimum interval, so a pending report that
+ * couldn't be sent doesn't wait for the next ps4SetOutput() call
+ */
+static void ps4_output_retry( void )
+{
+    bool arm = false;
+
+    portENTER_CRITICAL(&ps4_output_lock);
+    if (ps4_output_has_pending && !ps4_output_timer_armed && ps4_output_timer != NULL) {
+        ps4_output_timer_armed = true;
+        arm = true;
+    }
+    portEXIT_CRITICAL(&ps4_output_lock);
+
+    if (arm) {
+        esp_timer_start_once(ps4_output_timer, PS4_OUTPUT_MIN_INTERVAL_US);
+    }
+}
+
+
+static void ps4_output_timer_callback( void *arg )
+{
+    portENTER_CRITICAL(&ps4_output_lock);
+    ps4_output_timer_armed = false;
+    portEXIT_CRITICAL(&ps4_output_lock);
+
+    ps4_output_flush();
+}
+
+
+static bool ps4_send_cmd( ps4_cmd_t cmd )
+{
+    hid_cmd_t hid_cmd = { .data = {0x80, 0x00, 0xFF} };
+    uint16_t len = sizeof(hid_cmd.data);
+
+    hid_cmd.code = hid_cmd_code_set_report | hid_cmd_code_type_output;
+    hid_cmd.identifier = hid_cmd_identifier_ps4_control;
+
+    hid_cmd.data[ps4_control_packet_index_small_rumble] = cmd.smallRumble; // Small Rumble
+    hid_cmd.data[ps4_control_packet_index_large_rumble] = cmd.largeRumble; // Big rumble
+
+    hid_cmd.data[ps4_control_packet_index_red] = cmd.r; // Red
+    hid_cmd.data[ps4_control_packet_index_green] = cmd.g; // Green
+    hid_cmd.data[ps4_control_packet_index_blue] = cmd.b; // Blue
+
+    hid_cmd.data[ps4_control_packet_index_flash_on_time] = cmd.flashOn; // Time to flash bright (255 = 2.5 seconds)
+    hid_cmd.data[ps4_control_packet_index_flash_off_time] = cmd.flashOff; // Time to flash dark (255 = 2.5 seconds)
+
+    return ps4_gap_send_hid( &hid_cmd, len );
+}
@@ -19,6 +19,9 @@
 #define PS4_GAP_ID_HIDC 0x40
 #define PS4_GAP_ID_HIDI 0x41
 
+/* BT_HDR, L2CAP header space and the biggest HID command (instead of BT_DEFAULT_BUFFER_SIZE per report) */
+#define PS4_HID_SEND_BUFFER_SIZE (sizeof(BT_HDR) + L2CAP_MIN_OFFSET + sizeof(hid_cmd_t) + 4)
+
 
 /********************************************************************************/
 /*              L O C A L    F U N C T I O N     P R O T O T Y P E S            */
@@ -39,6 +42,7 @@ uint16_t gap_handle_hidc = GAP_INVALID_HANDLE;
 uint16_t gap_handle_hidi = GAP_INVALID_HANDLE;
 
 static bool is_connected = false;
+static bool is_congested = false;
 
 
 /********************************************************************************/
@@ -75,27 +79,47 @@ void ps4_gap_init_services()
 }
 
 
+/*******************************************************************************
+**
+** Function         ps4_gap_is_congested
+**
+** Description      This returns whether L2CAP reported the HID control
+**                  channel as congested (the last report is still queued).
+**
+** Returns          bool
+**
+*******************************************************************************/
+bool ps4_gap_is_congested()
+{
+    return is_congested;
+}
+
+
 /*******************************************************************************
 **
 ** Function         ps4_gap_send_hid
 **
 ** Description      This function sends the HID command using the GAP service.
+**                  The buffer is owned (and freed) by the stack after the
+**                  write, so it is only as big as the command needs.
 **
-** Returns          void
+** Returns          true if the command was queued for sending
 **
 *******************************************************************************/
-void ps4_gap_send_hid( hid_cmd_t *hid_cmd, uint8_t len )
+bool ps4_gap_send_hid( hid_cmd_t *hid_cmd, uint8_t len )
 {
     uint8_t result;
     BT_HDR     *p_buf;
+    const uint16_t cmd_len = len + ( sizeof(*hid_cmd) - sizeof(hid_cmd->data) );
 
-    p_buf = (BT_HDR *)osi_malloc(BT_DEFAULT_BUFFER_SIZE);
+    p_buf = (BT_HDR *)osi_malloc(PS4_HID_SEND_BUFFER_SIZE);
 
     if( !p_buf ){
         ESP_LOGE(PS4_TAG, "[%s] allocating buffer for sending the command failed", __func__);
+        return false;
     }
 
-    p_buf->len = len + ( sizeof(*hid_cmd) - sizeof(hid_cmd->data) );
+    p_buf->len = cmd_len;
     p_buf->offset = L2CAP_MIN_OFFSET;
 
     memcpy ((uint8_t *)(p_buf + 1) + p_buf->offset, (uint8_t*)hid_cmd, p_buf->len);
@@ -105,10 +129,12 @@ void ps4_gap_send_hid( hid_cmd_t *hid_cmd, uint8_t len )
     if (result == BT_PASS) {
         ESP_LOGI(PS4_TAG, "[%s] sending command: success\n", __func__);
         //printf("[%s] sending command: success", __func__);
+        return true;
     }
     else {
         ESP_LOGE(PS4_TAG, "[%s] sending command: failed\n", __func__);
         //printf("[%s] sending command: success", __func__);
+        return false;
     }
 }
 
@@ -148,7 +174,8 @@ static uint16_t ps4_gap_init_service( char *name, uint16_t psm, uint8_t security
 ** Function         ps4_gap_event_handle
 **
 ** Description      Callback for GAP events, currently handling the connection
-**                  opened, connection closed, and data available events.
+**                  opened, connection closed, data available and (un)congested
+**                  events.
 **
 ** Returns          void
 **
@@ -162,6 +189,7 @@ static void ps4_gap_event_handle(UINT16 gap_handle, UINT16 event)
             ps4_gap_update_connected();
 
             if(was_connected != is_connected){
+                is_congested = false;
                 ps4_connect_event(is_connected);
             }
 
@@ -183,6 +211,19 @@ static void ps4_gap_event_handle(UINT16 gap_handle, UINT16 event)
             break;
         }
 
+        case GAP_EVT_CONN_CONGESTED:
+            if(gap_handle == gap_handle_hidc){
+                is_congested = true;
+            }
+            break;
+
+        case GAP_EVT_CONN_UNCONGESTED:
+            if(gap_handle == gap_handle_hidc){
+                is_congested = false;
+                ps4_output_flush();
+            }
+            break;
+
         default:
             break;
     }
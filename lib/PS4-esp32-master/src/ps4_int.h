@@ -46,6 +46,11 @@
 #define PS4_REPORT_BUFFER_SIZE 77
 #define PS4_HID_BUFFER_SIZE    50
 
+/** Minimum time between two output reports, updates in between are merged */
+#ifndef PS4_OUTPUT_MIN_INTERVAL_US
+#define PS4_OUTPUT_MIN_INTERVAL_US 20000
+#endif
+
 /********************************************************************************/
 /*                         S H A R E D   T Y P E S                              */
 /********************************************************************************/
@@ -87,7 +92,8 @@ enum ps4_control_packet_index {
 /********************************************************************************/
 
 void ps4_connect_event(uint8_t is_connected);
-void ps4_packet_event( ps4_t ps4, ps4_event_t event );
+void ps4_packet_event( const ps4_t *ps4, const ps4_event_t *event );
+void ps4_output_flush();
 
 
 /********************************************************************************/
@@ -109,7 +115,8 @@ void ps4_spp_init();
 /********************************************************************************/
 
 bool ps4_gap_is_connected();
+bool ps4_gap_is_congested();
 void ps4_gap_init_services();
-void ps4_gap_send_hid( hid_cmd_t *hid_cmd, uint8_t len );
+bool ps4_gap_send_hid( hid_cmd_t *hid_cmd, uint8_t len );
 
 #endif
@@ -4,6 +4,7 @@
 #include "include/ps4.h"
 #include "ps4_int.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -43,37 +44,16 @@ enum ps4_packet_index {
     ps4_packet_index_status = 42
 };
 
-enum ps4_button_mask {
-    ps4_button_mask_up       = 0,
-    ps4_button_mask_right    = 1 << 1,
-    ps4_button_mask_down     = 1 << 2,
-    ps4_button_mask_left     = (1 << 1) + (1 << 2),
-
-    ps4_button_mask_upright  = 1,
-    ps4_button_mask_upleft   = 1 + (1 << 1) + (1 << 2),
-    ps4_button_mask_downright= 1 + (1 << 1),
-    ps4_button_mask_downleft = 1 + (1 << 2),
-
-    ps4_button_mask_arrows   = 0xf,
-
-    ps4_button_mask_square   = 1 << 4,
-    ps4_button_mask_cross    = 1 << 5,
-    ps4_button_mask_circle   = 1 << 6,
-    ps4_button_mask_triangle = 1 << 7,
-
-    ps4_button_mask_l1       = 1 << 8,
-    ps4_button_mask_r1       = 1 << 9,
-	ps4_button_mask_l2       = 1 << 10,
-    ps4_button_mask_r2       = 1 << 11,
-		
-    ps4_button_mask_share    = 1 << 12,
-    ps4_button_mask_options  = 1 << 13,
-		
-    ps4_button_mask_l3       = 1 << 14,
-    ps4_button_mask_r3       = 1 << 15,
-
-    ps4_button_mask_ps       = 1 << 16,
-    ps4_button_mask_touchpad = 1 << 17
+enum ps4_raw_button_mask {
+    ps4_raw_button_mask_hat     = 0xf, // d-pad as hat value 0 (up) ... 7 (upleft), 8 is released
+    ps4_raw_button_mask_buttons = 0x3fff0 // square ... touchpad, same bits as ps4_button_mask
+};
+
+/* ps4_button_mask bits of the hat values */
+static const uint32_t ps4_hat_mask[16] = {
+    ps4_button_mask_up, ps4_button_mask_upright, ps4_button_mask_right, ps4_button_mask_downright,
+    ps4_button_mask_down, ps4_button_mask_downleft, ps4_button_mask_left, ps4_button_mask_upleft,
+    0, 0, 0, 0, 0, 0, 0, 0
 };
 
 enum ps4_status_mask {
@@ -93,14 +73,20 @@ ps4_status_t ps4_parse_packet_status( uint8_t *packet );
 ps4_analog_stick_t ps4_parse_packet_analog_stick( uint8_t *packet );
 ps4_analog_button_t ps4_parse_packet_analog_button( uint8_t *packet );
 ps4_button_t ps4_parse_packet_buttons( uint8_t *packet );
-ps4_event_t ps4_parse_event( ps4_t prev, ps4_t cur );
+void ps4_parse_event( const ps4_t *prev, const ps4_t *cur, ps4_event_t *event );
 
 
 /********************************************************************************/
 /*                         L O C A L    V A R I A B L E S                       */
 /********************************************************************************/
 
-static ps4_t ps4;
+/* Double buffer of the parsed packets and their events. A packet is parsed in place into the slot which
+ * isn't published, so the bluetooth task never copies the state and readers of the published slot aren't disturbed.
+ * ps4_sequence is odd while a packet is parsed, the published slot is (ps4_sequence >> 1) & 1.
+ */
+static ps4_t ps4[2];
+static ps4_event_t ps4_events[2];
+static uint32_t ps4_sequence = 0;
 static ps4_event_callback_t ps4_event_cb = NULL;
 
 /********************************************************************************/
@@ -124,29 +110,76 @@ void printBytes2Binary(uint8_t *packet, int byteCount) {
 
 void ps4_parse_packet( uint8_t *packet )
 {
-    ps4_t prev_ps4 = ps4;
+    const uint32_t sequence = ps4_sequence; // only written here
+    const uint8_t slot = ((sequence >> 1) + 1) & 1;
+    const ps4_t *prev = &ps4[slot ^ 1];
+    ps4_t *cur = &ps4[slot];
+    ps4_event_t *event = &ps4_events[slot];
+
+    __atomic_store_n(&ps4_sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    cur->timestamp_us  = esp_timer_get_time();
 
     //time_t newTime = clock();
     //if (newTime - prevTime > 1000) {
     //    printf("%c", 255);
     //    printBytes2Binary(packet, 44);
-    //    printf("Battery = %d\n", ps4.status.battery);
+    //    printf("Battery = %d\n", cur->status.battery);
     //    prevTime = newTime;
     //}
 
-    ps4.button        = ps4_parse_packet_buttons(packet);
-    ps4.analog.stick  = ps4_parse_packet_analog_stick(packet);
-    ps4.analog.button = ps4_parse_packet_analog_button(packet);
-    //ps4.sensor        = ps4_parse_packet_sensor(packet);
-    ps4.status        = ps4_parse_packet_status(packet);
+    cur->button        = ps4_parse_packet_buttons(packet);
+    cur->analog.stick  = ps4_parse_packet_analog_stick(packet);
+    cur->analog.button = ps4_parse_packet_analog_button(packet);
+    //cur->sensor        = ps4_parse_packet_sensor(packet);
+    cur->status        = ps4_parse_packet_status(packet);
 
-    ps4_event_t ps4_event = ps4_parse_event( prev_ps4, ps4 );
+    ps4_parse_event( prev, cur, event );
 
-    ps4_packet_event( ps4, ps4_event );
+    __atomic_store_n(&ps4_sequence, sequence + 2, __ATOMIC_RELEASE);
+
+    ps4_packet_event( cur, event );
 
 }
 
 
+/*******************************************************************************
+**
+** Function         ps4ReadState
+**
+** Description      Copies the last parsed packet and its events (if event
+**                  isn't NULL), can be called from any task. The copy is
+**                  retried if the parser overwrote the slot while copying.
+**
+**
+** Returns          number of parsed packets
+**
+*******************************************************************************/
+uint32_t ps4ReadState( ps4_t *state, ps4_event_t *event )
+{
+    uint32_t before;
+    uint32_t after;
+
+    do {
+        before = __atomic_load_n(&ps4_sequence, __ATOMIC_ACQUIRE);
+        const uint8_t slot = (before >> 1) & 1;
+
+        memcpy(state, &ps4[slot], sizeof(ps4_t));
+        if (event != NULL) {
+            memcpy(event, &ps4_events[slot], sizeof(ps4_event_t));
+        }
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        after = __atomic_load_n(&ps4_sequence, __ATOMIC_RELAXED);
+
+    // the slot is only written again when the parser starts the packet after the next one
+    } while (after - (before & ~1u) > 2);
+
+    return before >> 1;
+}
+
+
 /********************************************************************************/
 /*                      L O C A L    F U N C T I O N S                          */
 /********************************************************************************/
@@ -154,74 +187,16 @@ void ps4_parse_packet( uint8_t *packet )
 /******************/
 /*    E V E N T   */
 /******************/
-ps4_event_t ps4_parse_event( ps4_t prev, ps4_t cur )
+void ps4_parse_event( const ps4_t *prev, const ps4_t *cur, ps4_event_t *event )
 {
-    ps4_event_t ps4_event;
-
-    /* Button down events */
-    ps4_event.button_down.options  = !prev.button.options  && cur.button.options;
-    ps4_event.button_down.l3       = !prev.button.l3       && cur.button.l3;
-    ps4_event.button_down.r3       = !prev.button.r3       && cur.button.r3;
-    ps4_event.button_down.share    = !prev.button.share    && cur.button.share;
-
-    ps4_event.button_down.up       = !prev.button.up       && cur.button.up;
-    ps4_event.button_down.right    = !prev.button.right    && cur.button.right;
-    ps4_event.button_down.down     = !prev.button.down     && cur.button.down;
-    ps4_event.button_down.left     = !prev.button.left     && cur.button.left;
-
-    ps4_event.button_down.upright  = !prev.button.upright  && cur.button.upright;
-    ps4_event.button_down.upleft   = !prev.button.upleft   && cur.button.upleft;
-    ps4_event.button_down.downright= !prev.button.downright&& cur.button.downright;
-    ps4_event.button_down.downleft = !prev.button.downleft && cur.button.downleft;
-
-    ps4_event.button_down.l2       = !prev.button.l2       && cur.button.l2;
-    ps4_event.button_down.r2       = !prev.button.r2       && cur.button.r2;
-    ps4_event.button_down.l1       = !prev.button.l1       && cur.button.l1;
-    ps4_event.button_down.r1       = !prev.button.r1       && cur.button.r1;
-
-    ps4_event.button_down.triangle = !prev.button.triangle && cur.button.triangle;
-    ps4_event.button_down.circle   = !prev.button.circle   && cur.button.circle;
-    ps4_event.button_down.cross    = !prev.button.cross    && cur.button.cross;
-    ps4_event.button_down.square   = !prev.button.square   && cur.button.square;
-
-    ps4_event.button_down.ps       = !prev.button.ps       && cur.button.ps;
-    ps4_event.button_down.touchpad = !prev.button.touchpad && cur.button.touchpad;
-
-    /* Button up events */
-    ps4_event.button_up.options  = !prev.button.options  && cur.button.options;
-    ps4_event.button_up.l3       = !prev.button.l3       && cur.button.l3;
-    ps4_event.button_up.r3       = !prev.button.r3       && cur.button.r3;
-    ps4_event.button_up.share    = !prev.button.share    && cur.button.share;
-
-    ps4_event.button_up.up       = !prev.button.up       && cur.button.up;
-    ps4_event.button_up.right    = !prev.button.right    && cur.button.right;
-    ps4_event.button_up.down     = !prev.button.down     && cur.button.down;
-    ps4_event.button_up.left     = !prev.button.left     && cur.button.left;
-
-    ps4_event.button_up.upright  = !prev.button.upright  && cur.button.upright;
-    ps4_event.button_up.upleft   = !prev.button.upleft   && cur.button.upleft;
-    ps4_event.button_up.downright= !prev.button.downright&& cur.button.downright;
-    ps4_event.button_up.downleft = !prev.button.downleft && cur.button.downleft;
-
-    ps4_event.button_up.l2       = !prev.button.l2       && cur.button.l2;
-    ps4_event.button_up.r2       = !prev.button.r2       && cur.button.r2;
-    ps4_event.button_up.l1       = !prev.button.l1       && cur.button.l1;
-    ps4_event.button_up.r1       = !prev.button.r1       && cur.button.r1;
-
-    ps4_event.button_up.triangle = !prev.button.triangle && cur.button.triangle;
-    ps4_event.button_up.circle   = !prev.button.circle   && cur.button.circle;
-    ps4_event.button_up.cross    = !prev.button.cross    && cur.button.cross;
-    ps4_event.button_up.square   = !prev.button.square   && cur.button.square;
-
-    ps4_event.button_up.ps       = !prev.button.ps       && cur.button.ps;
-    ps4_event.button_up.touchpad = !prev.button.touchpad && cur.button.touchpad;
-
-	ps4_event.analog_move.stick.lx = cur.analog.stick.lx != 0;
-	ps4_event.analog_move.stick.ly = cur.analog.stick.ly != 0;
-	ps4_event.analog_move.stick.rx = cur.analog.stick.rx != 0;
-	ps4_event.analog_move.stick.ry = cur.analog.stick.ry != 0;
-
-    return ps4_event;
+    /* Button down and up events */
+    event->button_down.mask = cur->button.mask & ~prev->button.mask;
+    event->button_up.mask   = prev->button.mask & ~cur->button.mask;
+
+	event->analog_move.stick.lx = cur->analog.stick.lx != 0;
+	event->analog_move.stick.ly = cur->analog.stick.ly != 0;
+	event->analog_move.stick.rx = cur->analog.stick.rx != 0;
+	event->analog_move.stick.ry = cur->analog.stick.ry != 0;
 }
 
 /********************/
@@ -258,36 +233,11 @@ ps4_analog_button_t ps4_parse_packet_analog_button( uint8_t *packet )
 ps4_button_t ps4_parse_packet_buttons( uint8_t *packet )
 {
     ps4_button_t ps4_button;
-    uint32_t ps4_buttons_raw = *((uint32_t*)&packet[ps4_packet_index_buttons]);
-	uint8_t arrow_buttons_only = ps4_button_mask_arrows & ps4_buttons_raw;
-
-    ps4_button.options  = (ps4_buttons_raw & ps4_button_mask_options)  ? true : false;
-    ps4_button.l3       = (ps4_buttons_raw & ps4_button_mask_l3)       ? true : false;
-    ps4_button.r3       = (ps4_buttons_raw & ps4_button_mask_r3)       ? true : false;
-    ps4_button.share    = (ps4_buttons_raw & ps4_button_mask_share)    ? true : false;
-
-    ps4_button.up        = arrow_buttons_only == ps4_button_mask_up;
-    ps4_button.right     = arrow_buttons_only == ps4_button_mask_right;
-    ps4_button.down      = arrow_buttons_only == ps4_button_mask_down;
-    ps4_button.left      = arrow_buttons_only == ps4_button_mask_left;
-
-    ps4_button.upright   = arrow_buttons_only == ps4_button_mask_upright;
-    ps4_button.upleft    = arrow_buttons_only == ps4_button_mask_upleft;
-    ps4_button.downright = arrow_buttons_only == ps4_button_mask_downright;
-    ps4_button.downleft  = arrow_buttons_only == ps4_button_mask_downleft;
-
-    ps4_button.l2       = (ps4_buttons_raw & ps4_button_mask_l2)       ? true : false;
-    ps4_button.r2       = (ps4_buttons_raw & ps4_button_mask_r2)       ? true : false;
-    ps4_button.l1       = (ps4_buttons_raw & ps4_button_mask_l1)       ? true : false;
-    ps4_button.r1       = (ps4_buttons_raw & ps4_button_mask_r1)       ? true : false;
-
-    ps4_button.triangle = (ps4_buttons_raw & ps4_button_mask_triangle) ? true : false;
-    ps4_button.circle   = (ps4_buttons_raw & ps4_button_mask_circle)   ? true : false;
-    ps4_button.cross    = (ps4_buttons_raw & ps4_button_mask_cross)    ? true : false;
-    ps4_button.square   = (ps4_buttons_raw & ps4_button_mask_square)   ? true : false;
-
-    ps4_button.ps       = (ps4_buttons_raw & ps4_button_mask_ps)       ? true : false;
-    ps4_button.touchpad = (ps4_buttons_raw & ps4_button_mask_touchpad) ? true : false;
+    const uint32_t ps4_buttons_raw = packet[ps4_packet_index_buttons]
+        | (packet[ps4_packet_index_buttons + 1] << 8)
+        | (packet[ps4_packet_index_buttons + 2] << 16);
+
+    ps4_button.mask = (ps4_buttons_raw & ps4_raw_button_mask_buttons) | ps4_hat_mask[ps4_buttons_raw & ps4_raw_button_mask_hat];
 
     return ps4_button;
 }
@@ -0,0 +1,130 @@
+#include <Arduino.h>
+
+#include "Anytime.h"
+#include "esp_timer.h"
+
+namespace SnakeGame {
+using namespace Game;
+
+// Candidate directions (same order as the Direction constants)
+static const int8_t anytime_directions[8][2] = {
+    {0, -1}, {0, 1}, {-1, 0}, {1, 0}, {1, -1}, {-1, -1}, {-1, 1}, {1, 1},
+};
+
+// Leaving the gameboard is worse than anything else
+static const int32_t anytime_game_over_value = -(1 << 20);
+
+
+void AnytimeStats::print() const {
+    printf("Anytime-AI: calls = %u, deadline hits = %u, depths =", this->calls, this->deadline_hits);
+    for (int32_t depth = 0; depth <= max_depth; ++depth) { printf(" %d:%u", depth, this->depth_count[depth]); }
+    printf("\n");
+}
+
+// Best value reachable from states[ply] within depth ticks
+int32_t AnytimeAi::search(const int32_t ply, const int32_t depth) {
+
+    // check the clock every few nodes
+    if ((++this->nodes & 0x7) == 0 && esp_timer_get_time() >= this->deadline_us) { this->timed_out = true; }
+    if (this->timed_out) { return 0; }
+
+    // end close to a fruit
+    if (depth == 0) { return -this->states[ply].nearest_fruit_distance(); }
+
+    int32_t best = anytime_game_over_value;
+    for (int32_t candidate = 0; candidate < 8; ++candidate) {
+
+        // going back isn't possible (it would keep the old direction)
+        const GameSnapshot& state = this->states[ply];
+        if (state.reverses(anytime_directions[candidate][0], anytime_directions[candidate][1])) { continue; }
+
+        GameSnapshot& next = this->states[ply + 1];
+        next = state;
+        const uint32_t events = next.step(anytime_directions[candidate][0], anytime_directions[candidate][1]);
+        if (events & Tick_Game_Over) { continue; }
+
+        // the earlier a fruit is eaten the better, losing the tail costs as much as a fruit
+        int32_t value = this->search(ply + 1, depth - 1);
+        if (events & Tick_Eat) { value += 16 * depth; }
+        if (events & Tick_Bite) { value -= 16 * depth; }
+        if (value > best) { best = value; }
+    }
+
+    return best;
+}
+
+Direction AnytimeAi::get_direction(const GameBoard& game_board, const FruitIndex& fruit_index, const Snake& snake, const int64_t deadline_us) {
+
+    const Direction fallback = get_direction_from_game_ai(game_board, fruit_index, snake);
+    if (!this->states[0].capture(game_board, fruit_index, snake, esp_random())) {
+        this->stats.calls += 1;
+        this->stats.depth_count[0] += 1;
+        return fallback;
+    }
+
+    return this->search_direction(fallback, deadline_us);
+}
+
+Direction AnytimeAi::get_direction(const GameSnapshot& snapshot, const int64_t deadline_us) {
+
+    // the direction towards the fruit is on the gameboard, game_tick() and step() invert it again (like get_direction_from_game_ai())
+    Direction fallback = snapshot.nearest_fruit_direction();
+    if (snapshot.invert_x) { fallback.x *= (-1); }
+    if (snapshot.invert_y) { fallback.y *= (-1); }
+
+    this->states[0] = snapshot;
+    return this->search_direction(fallback, deadline_us);
+}
+
+Direction AnytimeAi::search_direction(const Direction& fallback, const int64_t deadline_us) {
+
+    this->stats.calls += 1;
+    this->deadline_us = deadline_us;
+    this->nodes = 0;
+    this->timed_out = false;
+
+    // Iterative deepening, keep the answer of the deepest completed search
+    Direction best_dir = fallback;
+    int32_t completed_depth = 0;
+    for (int32_t depth = 1; depth <= max_depth && !this->timed_out; ++depth) {
+
+        int32_t best_value = anytime_game_over_value - 1;
+        Direction depth_best_dir = fallback;
+        for (int32_t candidate = 0; candidate < 8 && !this->timed_out; ++candidate) {
+
+            const GameSnapshot& root = this->states[0];
+            if (root.reverses(anytime_directions[candidate][0], anytime_directions[candidate][1])) { continue; }
+
+            this->states[1] = root;
+            const uint32_t events = this->states[1].step(anytime_directions[candidate][0], anytime_directions[candidate][1]);
+            int32_t value = anytime_game_over_value;
+            if (!(events & Tick_Game_Over)) {
+                value = this->search(1, depth - 1);
+                if (events & Tick_Eat) { value += 16 * depth; }
+                if (events & Tick_Bite) { value -= 16 * depth; }
+            }
+
+            // the fallback wins ties
+            const Direction dir(anytime_directions[candidate][0], anytime_directions[candidate][1]);
+            if (value > best_value || (value == best_value && dir == fallback)) {
+                best_value = value;
+                depth_best_dir = dir;
+            }
+        }
+
+        if (!this->timed_out) {
+            best_dir = depth_best_dir;
+            completed_depth = depth;
+        }
+    }
+
+    if (this->timed_out) { this->stats.deadline_hits += 1; }
+    this->stats.depth_count[completed_depth] += 1;
+    return best_dir;
+}
+
+Direction get_direction_from_anytime_ai(const GameBoard& game_board, const FruitIndex& fruit_index, const Snake& snake, AnytimeAi& anytime_ai) {
+    return anytime_ai.get_direction(game_board, fruit_index, snake, esp_timer_get_time() + 1000);
+}
+
+}; // namespace SnakeGame
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "stdint.h"
+#include "Game.h"
+#include "Snake.h"
+#include "FruitIndex.h"
+#include "Snapshot.h"
+
+namespace SnakeGame {
+
+// How often the anytime AI ran out of time and how deep it got
+class AnytimeStats {
+
+    public:
+
+        static const int32_t max_depth = 6;
+
+        uint32_t calls;
+        uint32_t deadline_hits; // search was cut off by the deadline
+        uint32_t depth_count[max_depth + 1]; // deepest completed depth per call (0 = fallback was used)
+
+    public:
+
+        AnytimeStats() { this->clear(); }
+
+        void clear() {
+            this->calls = 0;
+            this->deadline_hits = 0;
+            for (auto& count : this->depth_count) { count = 0; }
+        }
+
+        void merge(const AnytimeStats& other) {
+            this->calls += other.calls;
+            this->deadline_hits += other.deadline_hits;
+            for (int32_t depth = 0; depth <= max_depth; ++depth) { this->depth_count[depth] += other.depth_count[depth]; }
+        }
+
+        void print() const;
+};
+
+/* Anytime AI with a hard deadline.
+ * Iterative deepening search over GameSnapshot copies (1, 2, ... max_depth ticks ahead). Every completed
+ * depth refines the answer, when the deadline is reached the running depth is dropped and the best direction
+ * of the last completed depth is returned, so the call returns at most one search node after the deadline.
+ * The snapshots for all depths are part of the object (about 8 KB).
+ */
+class AnytimeAi {
+
+    public:
+
+        static const int32_t max_depth = AnytimeStats::max_depth;
+
+        AnytimeStats stats;
+
+    protected:
+
+        GameSnapshot states[max_depth + 1];
+        int64_t deadline_us;
+        int32_t nodes;
+        bool timed_out;
+
+        int32_t search(const int32_t ply, const int32_t depth);
+
+        // search from states[0]
+        Game::Direction search_direction(const Game::Direction& fallback, const int64_t deadline_us);
+
+    public:
+
+        AnytimeAi(): deadline_us(0), nodes(0), timed_out(false) {}
+
+        // deadline_us is an absolute time of esp_timer_get_time()
+        Game::Direction get_direction(const Game::GameBoard& game_board, const FruitIndex& fruit_index, const Snake& snake, const int64_t deadline_us);
+        Game::Direction get_direction(const GameSnapshot& snapshot, const int64_t deadline_us);
+};
+
+// Anytime AI with 1 ms per tick (for the benchmark, which keeps one anytime_ai per worker and reports its stats)
+Game::Direction get_direction_from_anytime_ai(const Game::GameBoard& game_board, const FruitIndex& fruit_index, const Snake& snake, AnytimeAi& anytime_ai);
+
+}; // namespace SnakeGame
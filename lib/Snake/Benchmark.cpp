@@ -0,0 +1,172 @@
+#include <Arduino.h>
+
+#include "Benchmark.h"
+#include "MonteCarlo.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include <atomic>
+#include <vector>
+#include <algorithm>
+
+namespace SnakeGame {
+using namespace Game;
+
+// Shared state of one benchmark run
+class BenchmarkContext {
+
+    public:
+
+        GameAi ai;
+        const GameBoard& game_board;
+        int32_t games;
+        int32_t max_ticks;
+        uint32_t seed;
+        std::atomic<int32_t> next_game;
+        std::vector<BenchmarkResult> results; // one per worker
+        std::atomic<int32_t> next_worker;
+        SemaphoreHandle_t done;
+
+    public:
+
+        BenchmarkContext(GameAi Ai, const GameBoard& Game_board, const int32_t Games, const int32_t Max_ticks, const uint32_t Seed, const int32_t Workers):
+            ai(Ai), game_board(Game_board), games(Games), max_ticks(Max_ticks), seed(Seed),
+            next_game(0), results(Workers), next_worker(0), done(xSemaphoreCreateCounting(Workers, 0)) {}
+};
+
+// The AIs with the signature of GameAi
+static Direction nearest_fruit_benchmark_ai(const GameBoard& game_board, const FruitIndex& fruit_index, const Snake& snake, BenchmarkWorkspace& workspace) {
+    return get_direction_from_game_ai(game_board, fruit_index, snake);
+}
+
+static Direction monte_carlo_benchmark_ai(const GameBoard& game_board, const FruitIndex& fruit_index, const Snake& snake, BenchmarkWorkspace& workspace) {
+    return get_direction_from_monte_carlo_ai(game_board, fruit_index, snake);
+}
+
+static Direction anytime_benchmark_ai(const GameBoard& game_board, const FruitIndex& fruit_index, const Snake& snake, BenchmarkWorkspace& workspace) {
+    return get_direction_from_anytime_ai(game_board, fruit_index, snake, workspace.anytime_ai);
+}
+
+// Play one game and add the statistics to result
+static void play_benchmark_game(const BenchmarkContext& context, const int32_t game_number, BenchmarkWorkspace& workspace, BenchmarkResult& result) {
+
+    const GameBoard& game_board = context.game_board;
+    Random rng(context.seed + game_number);
+    Direction dir(1, 0);
+    Direction old_dir(0, 0);
+    Snake snake(board_position(game_board, Position(game_board.width/2, game_board.height/2)));
+    FruitList fruits;
+    FruitIndex fruit_index(game_board);
+
+    // Place fruits on gameboard
+    for (auto i = 0; i < 10; ++i) {
+        fruits.push_back(create_random_fruit(game_board, fruits, snake, rng));
+        fruit_index.insert(game_board.position(fruits.back().position));
+    }
+
+    int32_t tick = 0;
+    while (tick < context.max_ticks) {
+
+        const int64_t start = esp_timer_get_time();
+
+        old_dir = dir;
+        dir = context.ai(game_board, fruit_index, snake, workspace);
+        if (dir == Direction::None) { dir = old_dir; }
+        const uint32_t events = game_tick(game_board, fruits, fruit_index, snake, dir, old_dir, rng);
+
+        result.tick_latency_us.record(esp_timer_get_time() - start);
+        ++tick;
+
+        if (events & Tick_Eat) { result.fruits += 1; }
+        if (events & Tick_Game_Over) { result.game_overs += 1; break; }
+    }
+
+    result.games += 1;
+    result.ticks += tick;
+    if (tick > result.max_survival) { result.max_survival = tick; }
+}
+
+// Worker task: take games from the shared counter until all are played
+static void benchmark_worker_task(void* args) {
+
+    BenchmarkContext* context = (BenchmarkContext*) args;
+    BenchmarkResult& result = context->results[context->next_worker.fetch_add(1)];
+    BenchmarkWorkspace workspace;
+
+    int32_t game_number;
+    while ((game_number = context->next_game.fetch_add(1)) < context->games) {
+        play_benchmark_game(*context, game_number, workspace, result);
+    }
+    result.anytime_stats = workspace.anytime_ai.stats;
+
+    xSemaphoreGive(context->done);
+    vTaskDelete(nullptr);
+}
+
+BenchmarkResult run_self_play_benchmark(const char* ai_name, GameAi ai, const GameBoard& game_board,
+    const int32_t games, const int32_t max_ticks, const uint32_t seed, const int32_t workers)
+{
+    BenchmarkContext context(ai, game_board, games, max_ticks, seed, workers);
+
+    const int64_t start = esp_timer_get_time();
+    for (int32_t i = 0; i < workers; ++i) {
+        xTaskCreatePinnedToCore(benchmark_worker_task, "Benchmark-Task", 4 * 8192, &context, 1, nullptr, i % portNUM_PROCESSORS);
+    }
+    for (int32_t i = 0; i < workers; ++i) {
+        xSemaphoreTake(context.done, portMAX_DELAY);
+    }
+    const int64_t stop = esp_timer_get_time();
+    vSemaphoreDelete(context.done);
+
+    BenchmarkResult result;
+    for (const auto& worker_result : context.results) { result.merge(worker_result); }
+    result.ai_name = ai_name;
+    result.wall_time_us = stop - start;
+    return result;
+}
+
+void print_benchmark_json(const GameBoard& game_board, const BenchmarkResult* results, const int32_t count) {
+
+    printf("{\"benchmark\":\"self_play\",\"board\":{\"width\":%d,\"height\":%d,\"loop_x\":%s,\"loop_y\":%s},\"results\":[",
+        game_board.width, game_board.height, game_board.loop_x ? "true" : "false", game_board.loop_y ? "true" : "false");
+
+    for (int32_t i = 0; i < count; ++i) {
+        const BenchmarkResult& result = results[i];
+        printf("%s{\"ai\":\"%s\",\"games\":%d,\"ticks\":%lld,\"wall_time_us\":%lld,"
+            "\"ticks_per_sec\":%.1f,\"games_per_sec\":%.3f,\"fruits_per_1k_ticks\":%.2f,"
+            "\"game_overs\":%d,\"survival_mean\":%.1f,\"survival_max\":%d,"
+            "\"tick_latency_us\":{\"min\":%u,\"mean\":%u,\"p50\":%u,\"p90\":%u,\"p99\":%u,\"max\":%u}",
+            (i > 0) ? "," : "", result.ai_name, result.games, (long long) result.ticks, (long long) result.wall_time_us,
+            result.ticks_per_second(), result.games_per_second(), result.fruits_per_1k_ticks(),
+            result.game_overs, result.mean_survival(), result.max_survival,
+            result.tick_latency_us.min(), result.tick_latency_us.mean(), result.tick_latency_us.percentile(50),
+            result.tick_latency_us.percentile(90), result.tick_latency_us.percentile(99), result.tick_latency_us.max());
+
+        const AnytimeStats& stats = result.anytime_stats;
+        if (stats.calls > 0) {
+            printf(",\"anytime\":{\"calls\":%u,\"deadline_hits\":%u,\"depths\":[", stats.calls, stats.deadline_hits);
+            for (int32_t depth = 0; depth <= AnytimeStats::max_depth; ++depth) { printf("%s%u", (depth > 0) ? "," : "", stats.depth_count[depth]); }
+            printf("]}");
+        }
+        printf("}");
+    }
+
+    printf("]}\n");
+}
+
+void run_self_play_benchmarks(const int32_t games, const int32_t max_ticks, const uint32_t seed) {
+
+    // Gameboard without loops, so games can end
+    static NeighbourStorage<30 * 10> neighbours;
+    const GameBoard game_board = GameBoard(30, 10, false, false, false, false).attach(neighbours);
+
+    const BenchmarkResult results[] = {
+        run_self_play_benchmark("nearest_fruit", nearest_fruit_benchmark_ai, game_board, games, max_ticks, seed),
+        run_self_play_benchmark("monte_carlo", monte_carlo_benchmark_ai, game_board, games, max_ticks, seed),
+        run_self_play_benchmark("anytime", anytime_benchmark_ai, game_board, games, max_ticks, seed),
+    };
+
+    print_benchmark_json(game_board, results, sizeof(results) / sizeof(results[0]));
+}
+
+}; // namespace SnakeGame
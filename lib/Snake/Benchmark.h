@@ -0,0 +1,71 @@
+#pragma once
+
+#include "stdint.h"
+#include "freertos/FreeRTOS.h"
+#include "Game.h"
+#include "Histogram.h"
+#include "Snake.h"
+#include "Anytime.h"
+
+namespace SnakeGame {
+
+// State an AI keeps over all games of a benchmark worker (the search buffers and statistics of the anytime AI)
+class BenchmarkWorkspace {
+
+    public:
+
+        AnytimeAi anytime_ai;
+};
+
+// Signature of a game AI which can be benchmarked
+typedef Game::Direction (*GameAi)(const Game::GameBoard& game_board, const FruitIndex& fruit_index, const Snake& snake, BenchmarkWorkspace& workspace);
+
+// Aggregated results of a self-play benchmark for one AI
+class BenchmarkResult {
+
+    public:
+
+        const char* ai_name;
+        int32_t games;
+        int64_t ticks;
+        int64_t fruits;
+        int32_t game_overs;
+        int32_t max_survival;
+        int64_t wall_time_us;
+        Histogram tick_latency_us; // AI decision + game_tick()
+        AnytimeStats anytime_stats; // of the anytime AI of all workers (calls = 0 for the other AIs)
+
+    public:
+
+        BenchmarkResult(): ai_name(""), games(0), ticks(0), fruits(0), game_overs(0), max_survival(0), wall_time_us(0) {}
+
+        void merge(const BenchmarkResult& other) {
+            this->games += other.games;
+            this->ticks += other.ticks;
+            this->fruits += other.fruits;
+            this->game_overs += other.game_overs;
+            if (other.max_survival > this->max_survival) { this->max_survival = other.max_survival; }
+            this->tick_latency_us.merge(other.tick_latency_us);
+            this->anytime_stats.merge(other.anytime_stats);
+        }
+
+        double ticks_per_second() const { return (this->wall_time_us > 0) ? (1e6 * this->ticks / this->wall_time_us) : 0.0; }
+        double games_per_second() const { return (this->wall_time_us > 0) ? (1e6 * this->games / this->wall_time_us) : 0.0; }
+        double fruits_per_1k_ticks() const { return (this->ticks > 0) ? (1e3 * this->fruits / this->ticks) : 0.0; }
+        double mean_survival() const { return (this->games > 0) ? ((double) this->ticks / this->games) : 0.0; }
+};
+
+/* Play games independent games of snake with ai, each game seeded with seed + game number.
+ * A game ends when the snake leaves the gameboard or after max_ticks ticks.
+ * The games are distributed dynamically over workers tasks, one per core by default.
+ */
+BenchmarkResult run_self_play_benchmark(const char* ai_name, GameAi ai, const Game::GameBoard& game_board,
+    const int32_t games, const int32_t max_ticks, const uint32_t seed, const int32_t workers = portNUM_PROCESSORS);
+
+// Print benchmark results as one line of JSON
+void print_benchmark_json(const Game::GameBoard& game_board, const BenchmarkResult* results, const int32_t count);
+
+// Run the benchmark for all known AIs and print the results
+void run_self_play_benchmarks(const int32_t games = 64, const int32_t max_ticks = 2000, const uint32_t seed = 1);
+
+}; // namespace SnakeGame
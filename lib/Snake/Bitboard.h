@@ -0,0 +1,134 @@
+#pragma once
+
+#include "stdint.h"
+#include "Game.h"
+
+namespace SnakeGame {
+
+/* Set of cells of a gameboard (e.g. the body, the fruits or the free cells) with one word per row,
+ * bit x of rows[y] is the cell (x/y).
+ * Moving all cells by one step is a shift of every row (rotated within the width if the gameboard loops),
+ * so growing a set or flood filling it costs a few word operations per row instead of work per cell.
+ * Bitboard32 fits gameboards up to 32x32 (one uint32_t per row), Bitboard64 up to 64x64.
+ */
+template <typename Row, int32_t MaxHeight>
+class Bitboard {
+
+    public:
+
+        static const int32_t max_width = 8 * sizeof(Row);
+        static const int32_t max_height = MaxHeight;
+
+        int32_t width;
+        int32_t height;
+        bool loop_x;
+        bool loop_y;
+        Row mask; // columns inside the gameboard
+        Row rows[MaxHeight];
+
+    public:
+
+        static bool fits(const Game::GameBoard& game_board) {
+            return game_board.width > 0 && game_board.width <= max_width && game_board.height > 0 && game_board.height <= max_height;
+        }
+
+        // game_board has to fit into the bitboard (see fits())
+        Bitboard(const Game::GameBoard& game_board):
+            width(game_board.width), height(game_board.height),
+            loop_x(game_board.loop_x), loop_y(game_board.loop_y),
+            mask((game_board.width >= max_width) ? (Row) ~(Row)0 : (Row)(((Row)1 << game_board.width) - 1))
+        {
+            this->clear();
+        }
+
+        void clear() { for (int32_t y = 0; y < this->height; ++y) { this->rows[y] = 0; } }
+        void fill() { for (int32_t y = 0; y < this->height; ++y) { this->rows[y] = this->mask; } }
+
+        void set(const int32_t x, const int32_t y) { this->rows[y] |= ((Row)1 << x); }
+        void reset(const int32_t x, const int32_t y) { this->rows[y] &= ~((Row)1 << x); }
+        bool test(const int32_t x, const int32_t y) const { return (this->rows[y] >> x) & 1; }
+
+        void set(const Game::Position& pos) { this->set(pos.x, pos.y); }
+        void reset(const Game::Position& pos) { this->reset(pos.x, pos.y); }
+        bool test(const Game::Position& pos) const { return this->test(pos.x, pos.y); }
+
+        // number of cells in the set
+        int32_t count() const {
+            int32_t result = 0;
+            for (int32_t y = 0; y < this->height; ++y) { result += __builtin_popcountll((unsigned long long) this->rows[y]); }
+            return result;
+        }
+
+        // remove all cells of other from this set
+        void remove(const Bitboard& other) { for (int32_t y = 0; y < this->height; ++y) { this->rows[y] &= ~other.rows[y]; } }
+
+        // move every cell of row by steps (< width) in +x / -x direction, cells leaving the gameboard are lost or loop around
+        Row east(const Row row, const int32_t steps = 1) const {
+            const Row moved = (Row)(row << steps);
+            return (this->loop_x ? (Row)(moved | (row >> (this->width - steps))) : moved) & this->mask;
+        }
+        Row west(const Row row, const int32_t steps = 1) const {
+            const Row moved = (Row)(row >> steps);
+            return this->loop_x ? (Row)((moved | (Row)(row << (this->width - steps))) & this->mask) : moved;
+        }
+
+        /* All cells of free which can be reached from seed by moving along the row (Kogge-Stone fill),
+         * log2(width) shift steps in each direction.
+         */
+        Row fill_row(const Row seed, const Row free) const {
+            Row east_gen = seed & free;
+            Row west_gen = east_gen;
+            Row east_pro = free;
+            Row west_pro = free;
+            for (int32_t steps = 1; steps < this->width; steps <<= 1) {
+                east_gen |= east_pro & this->east(east_gen, steps);
+                west_gen |= west_pro & this->west(west_gen, steps);
+                east_pro &= this->east(east_pro, steps);
+                west_pro &= this->west(west_pro, steps);
+            }
+            return east_gen | west_gen;
+        }
+
+        /* Replace this set by all cells of free which can be reached from start (with diagonal moves if diagonal).
+         * Rows are filled sweeping down and up the gameboard until nothing changes.
+         * Returns the number of reachable cells (0 if start isn't free).
+         */
+        int32_t flood_fill(const Bitboard& free, const Game::Position& start, const bool diagonal = true) {
+
+            this->clear();
+            if (!free.test(start)) { return 0; }
+            this->rows[start.y] = this->fill_row((Row)1 << start.x, free.rows[start.y]);
+
+            bool changed = true;
+            while (changed) {
+                changed = false;
+                for (int32_t i = 0; i < 2 * this->height; ++i) {
+                    const int32_t y = (i < this->height) ? i : (2 * this->height - 1 - i);
+                    const Row seed = this->rows[y] | this->neighbour_row(y - 1, diagonal) | this->neighbour_row(y + 1, diagonal);
+                    if ((seed & ~this->rows[y] & free.rows[y]) == 0) { continue; }
+                    this->rows[y] = this->fill_row(seed, free.rows[y]);
+                    changed = true;
+                }
+            }
+
+            return this->count();
+        }
+
+    protected:
+
+        // cells of row y (looping around or empty outside the gameboard) as seen from the rows above or below
+        Row neighbour_row(int32_t y, const bool diagonal) const {
+            if (y < 0 || y >= this->height) {
+                if (!this->loop_y) { return 0; }
+                y = (y + this->height) % this->height;
+            }
+            const Row row = this->rows[y];
+            return diagonal ? (Row)(row | this->east(row) | this->west(row)) : row;
+        }
+
+};
+
+typedef Bitboard<uint32_t, 32> Bitboard32;
+typedef Bitboard<uint64_t, 64> Bitboard64;
+
+}; // namespace SnakeGame
@@ -0,0 +1,112 @@
+#include <Arduino.h>
+
+#include "Effects.h"
+
+namespace SnakeGame {
+using namespace Game;
+
+
+Effects::Effects(): head_color(CRGB::Red), body_color(CRGB::Green), body_palette(&gradient_palette()), body_gradient(255) {
+    this->clear();
+}
+
+void Effects::clear() {
+    this->wheel.clear();
+    for (int32_t type = 0; type < type_count; ++type) {
+        this->counts[type] = 0;
+        for (auto& handle : this->stacks[type]) { handle = Wheel::None; }
+    }
+}
+
+uint32_t Effects::duration(const Fruit::Type type) {
+    switch (type) {
+        case Fruit::SpeedBoost_Type: return 40;
+        case Fruit::SlowDown_Type: return 40;
+        case Fruit::Ghost_Type: return 30;
+        case Fruit::Rainbow_Type: return 60;
+        default: return 0;
+    }
+}
+
+void Effects::push(const int32_t type, const Wheel::Handle handle) {
+    this->stacks[type][this->counts[type]] = handle;
+    this->counts[type] += 1;
+}
+
+Effects::Wheel::Handle Effects::pop_front(const int32_t type) {
+    const Wheel::Handle handle = this->stacks[type][0];
+    for (int32_t i = 1; i < this->counts[type]; ++i) { this->stacks[type][i - 1] = this->stacks[type][i]; }
+    this->counts[type] -= 1;
+    this->stacks[type][this->counts[type]] = Wheel::None;
+    return handle;
+}
+
+Effects::Wheel::Handle Effects::pop_back(const int32_t type) {
+    this->counts[type] -= 1;
+    const Wheel::Handle handle = this->stacks[type][this->counts[type]];
+    this->stacks[type][this->counts[type]] = Wheel::None;
+    return handle;
+}
+
+void Effects::apply(const Fruit::Type type) {
+
+    if (type <= Fruit::Normal_Type || type >= type_count) { return; }
+
+    // speed boost and slow down cancel each other
+    const int32_t opposite = (type == Fruit::SpeedBoost_Type) ? Fruit::SlowDown_Type : ((type == Fruit::SlowDown_Type) ? Fruit::SpeedBoost_Type : -1);
+    if (opposite >= 0 && this->counts[opposite] > 0) {
+        this->wheel.cancel(this->pop_back(opposite));
+        return;
+    }
+
+    // all stacks in use: the oldest starts again
+    if (this->counts[type] == max_stacks) { this->wheel.cancel(this->pop_front(type)); }
+    this->push(type, this->wheel.schedule(duration(type), type));
+}
+
+void Effects::cancel(const Fruit::Type type) {
+    while (this->counts[type] > 0) { this->wheel.cancel(this->pop_back(type)); }
+}
+
+int32_t Effects::advance() {
+    // the stacks of a type all last the same number of ticks, so the oldest one expires first
+    return this->wheel.advance([this](const int32_t type) { this->pop_front(type); });
+}
+
+uint32_t Effects::remaining(const Fruit::Type type) const {
+    return (this->counts[type] > 0) ? this->wheel.remaining(this->stacks[type][this->counts[type] - 1]) : 0;
+}
+
+uint32_t Effects::tick_interval(const uint32_t base_ms) const {
+    uint32_t interval_ms = base_ms;
+    for (int32_t i = 0; i < this->counts[Fruit::SpeedBoost_Type]; ++i) { interval_ms = (interval_ms * 3) / 4; }
+    for (int32_t i = 0; i < this->counts[Fruit::SlowDown_Type]; ++i) { interval_ms = (interval_ms * 4) / 3; }
+    return (interval_ms < min_interval_ms) ? min_interval_ms : ((interval_ms > max_interval_ms) ? max_interval_ms : interval_ms);
+}
+
+void Effects::update_snake(Snake& snake) const {
+
+    snake.ghost = this->active(Fruit::Ghost_Type);
+    snake.head_color = this->head_color;
+
+    // rainbow: the whole rainbow along the body, moving on every tick, ghost: the body is dimmed
+    snake.body_base_color = this->body_color;
+    if (this->active(Fruit::Rainbow_Type)) {
+        snake.body_palette = &rainbow_palette();
+        snake.length_color_modifier = 255;
+        snake.time_color_modifier = rainbow_speed;
+    }
+    else if (this->active(Fruit::Ghost_Type)) {
+        snake.body_palette = nullptr;
+        snake.body_base_color.nscale8(64);
+        snake.time_color_modifier = 0;
+    }
+    else {
+        snake.body_palette = this->body_palette;
+        snake.length_color_modifier = this->body_gradient;
+        snake.time_color_modifier = 0;
+        snake.color_offset = 0;
+    }
+}
+
+}; // namespace SnakeGame
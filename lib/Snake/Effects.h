@@ -0,0 +1,78 @@
+#pragma once
+
+#include "stdint.h"
+#include "FastLED.h"
+#include "TimerWheel.h"
+#include "Snake.h"
+
+namespace SnakeGame {
+
+/* Timed effects of the power-up fruits, every eaten power-up adds a stack of its type for duration(type) ticks:
+ * SpeedBoost shortens the tick interval by a quarter per stack, SlowDown lengthens it by a third per stack
+ * (one cancels the newest stack of the other), Ghost lets the snake pass over its body (dimmed) and Rainbow moves
+ * the rainbow palette along the body.
+ * A type has at most max_stacks stacks, another one restarts the oldest. The stacks expire through a TimerWheel,
+ * so applying, expiring and cancelling are O(1) per tick.
+ */
+class Effects {
+
+    public:
+
+        static const int32_t type_count = Fruit::Rainbow_Type + 1;
+        static const int32_t max_stacks = 4;
+        static const uint32_t min_interval_ms = 50;
+        static const uint32_t max_interval_ms = 400;
+
+        typedef Game::TimerWheel<int32_t, type_count * max_stacks> Wheel;
+
+    protected:
+
+        Wheel wheel; // value: Fruit::Type
+        Wheel::Handle stacks[type_count][max_stacks]; // oldest first
+        int32_t counts[type_count];
+
+        void push(const int32_t type, const Wheel::Handle handle);
+        Wheel::Handle pop_front(const int32_t type);
+        Wheel::Handle pop_back(const int32_t type);
+
+    public:
+
+        CRGB head_color; // colors without effects
+        CRGB body_color;
+        const CRGBPalette256* body_palette;
+        uint8_t body_gradient; // Snake::length_color_modifier
+        static const uint8_t rainbow_speed = 8; // Snake::time_color_modifier with Rainbow
+
+    public:
+
+        Effects();
+
+        // Remove all effects (e.g. at the start of a round)
+        void clear();
+
+        // Ticks an effect of type lasts (0 for types without effect)
+        static uint32_t duration(const Fruit::Type type);
+
+        // Add a stack of type (when a fruit of type was eaten)
+        void apply(const Fruit::Type type);
+
+        // Cancel all stacks of type
+        void cancel(const Fruit::Type type);
+
+        // Next game tick, expired stacks are removed. Returns the number of expired stacks.
+        int32_t advance();
+
+        int32_t count(const Fruit::Type type) const { return this->counts[type]; }
+        bool active(const Fruit::Type type) const { return this->counts[type] > 0; }
+
+        // Ticks until the newest stack of type expires
+        uint32_t remaining(const Fruit::Type type) const;
+
+        // Tick interval for an interval of base_ms without effects
+        uint32_t tick_interval(const uint32_t base_ms) const;
+
+        // Collision rules and colors of the snake for the next tick
+        void update_snake(Snake& snake) const;
+};
+
+}; // namespace SnakeGame
@@ -0,0 +1,58 @@
+#include <Arduino.h>
+#include <PS4Controller.h>
+
+#include "Feedback.h"
+#include "Snake.h"
+
+namespace SnakeGame {
+
+
+void ControllerFeedback::update(const uint32_t tick_events, const int32_t length, const uint32_t board_size, const int64_t now_us) {
+
+    // lightbar: hue 96 (green) for an empty gameboard down to 0 (red)
+    const int32_t red_length = (board_size / red_fraction > 0) ? (board_size / red_fraction) : 1;
+    const int32_t hue = 96 - ((96 * ((length < red_length) ? length : red_length)) / red_length);
+    const CRGB new_color = CHSV(hue, 255, 255);
+    if (new_color != this->color) { this->color = new_color; this->changed = true; }
+
+    // rumble: biting wins over eating
+    if (tick_events & Tick_Bite) {
+        this->small_rumble = 0;
+        this->large_rumble = bite_rumble;
+        this->rumble_end_us = now_us + bite_rumble_us;
+        this->changed = true;
+    }
+    else if ((tick_events & Tick_Eat) && this->large_rumble == 0) {
+        this->small_rumble = eat_rumble;
+        this->rumble_end_us = now_us + eat_rumble_us;
+        this->changed = true;
+    }
+    else if ((this->small_rumble || this->large_rumble) && now_us >= this->rumble_end_us) {
+        this->small_rumble = 0;
+        this->large_rumble = 0;
+        this->changed = true;
+    }
+
+    if (this->changed) { this->send(); }
+}
+
+void ControllerFeedback::reset() {
+
+    if (this->small_rumble || this->large_rumble) {
+        this->small_rumble = 0;
+        this->large_rumble = 0;
+        this->send();
+    }
+}
+
+void ControllerFeedback::send() {
+
+    if (!PS4.isConnected()) { return; } // changed stays set, sent once the controller is connected
+    PS4.setLed(this->color.r, this->color.g, this->color.b);
+    PS4.setRumble(this->small_rumble, this->large_rumble);
+    PS4.sendToController();
+    this->changed = false;
+}
+
+
+}; // namespace SnakeGame
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "stdint.h"
+#include <FastLED.h>
+
+namespace SnakeGame {
+
+/* Lightbar and rumble of the PS4 controller as feedback of the game.
+ * The lightbar goes from green to red as the snake grows, eating a fruit gives a short light rumble
+ * and biting the tail a longer strong one. An output report is only requested when the output changes,
+ * the PS4 library merges the requests and rate limits the reports.
+ */
+class ControllerFeedback {
+
+    public:
+
+        static const int64_t eat_rumble_us = 150000;
+        static const int64_t bite_rumble_us = 400000;
+        static const uint8_t eat_rumble = 64; // small motor
+        static const uint8_t bite_rumble = 192; // large motor
+        static const int32_t red_fraction = 4; // red when the snake fills 1/red_fraction of the gameboard
+
+    protected:
+
+        CRGB color;
+        uint8_t small_rumble;
+        uint8_t large_rumble;
+        int64_t rumble_end_us;
+        bool changed;
+
+        void send();
+
+    public:
+
+        ControllerFeedback(): color(0, 0, 0), small_rumble(0), large_rumble(0), rumble_end_us(0), changed(false) {}
+
+        // After every tick with the TickEvent flags of game_tick()
+        void update(const uint32_t tick_events, const int32_t length, const uint32_t board_size, const int64_t now_us);
+
+        // Stop rumbling (e.g. at the end of a round)
+        void reset();
+};
+
+}; // namespace SnakeGame
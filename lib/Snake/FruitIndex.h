@@ -0,0 +1,194 @@
+#pragma once
+
+#include "stdint.h"
+#include <assert.h>
+#include <utility>
+#include "Game.h"
+
+// Width and height of the biggest gameboard of the fruit index (e.g. 128 for a 128x128 matrix, 64 needs about 4.6 kB)
+#ifndef SNAKE_FRUIT_INDEX_SIZE
+#define SNAKE_FRUIT_INDEX_SIZE 64
+#endif
+
+namespace SnakeGame {
+
+/* Bucket grid over the fruit positions on a game board.
+ * Every cell counts the fruits placed on it and every BucketSize x BucketSize bucket counts the fruits inside.
+ * Nearest-fruit queries use the Manhattan distance of the game board (looping around if the board loops)
+ * and only scan buckets which could still contain a closer fruit, so the cost depends on the board size
+ * but not on the number of fruits. All storage is part of the object, no heap memory is used.
+ */
+template <int32_t MaxWidth, int32_t MaxHeight, int32_t BucketSize = 4>
+class FruitGrid {
+
+    public:
+
+        static const int32_t max_width = MaxWidth;
+        static const int32_t max_height = MaxHeight;
+        static const int32_t bucket_size = BucketSize;
+        static const int32_t max_buckets_x = (MaxWidth + BucketSize - 1) / BucketSize;
+        static const int32_t max_buckets_y = (MaxHeight + BucketSize - 1) / BucketSize;
+
+    protected:
+
+        int32_t width;
+        int32_t height;
+        int32_t buckets_x;
+        int32_t buckets_y;
+        bool loop_x;
+        bool loop_y;
+        int32_t fruit_count;
+
+        uint8_t cells[MaxWidth * MaxHeight];
+        uint16_t buckets[max_buckets_x * max_buckets_y];
+
+        int32_t cell_index(const int32_t x, const int32_t y) const { return (y * MaxWidth) + x; }
+        int32_t bucket_index(const int32_t x, const int32_t y) const { return ((y / BucketSize) * max_buckets_x) + (x / BucketSize); }
+
+        // distance from coordinate to the interval [lo, hi] along one axis
+        static int32_t axis_interval_distance(const int32_t coord, const int32_t lo, const int32_t hi, const int32_t extent, const bool loop) {
+            if (coord < lo) {
+                const int32_t d = lo - coord;
+                return (loop && (coord + extent - hi) < d) ? (coord + extent - hi) : d;
+            }
+            else if (coord > hi) {
+                const int32_t d = coord - hi;
+                return (loop && (lo + extent - coord) < d) ? (lo + extent - coord) : d;
+            }
+            else {
+                return 0;
+            }
+        }
+
+        // lower bound for the distance from pos to any cell inside bucket (bx, by)
+        int32_t bucket_distance(const Game::Position& pos, const int32_t bx, const int32_t by) const {
+            const int32_t x0 = bx * BucketSize;
+            const int32_t y0 = by * BucketSize;
+            const int32_t x1 = ((x0 + BucketSize) < this->width ? (x0 + BucketSize) : this->width) - 1;
+            const int32_t y1 = ((y0 + BucketSize) < this->height ? (y0 + BucketSize) : this->height) - 1;
+            return axis_interval_distance(pos.x, x0, x1, this->width, this->loop_x) \
+                + axis_interval_distance(pos.y, y0, y1, this->height, this->loop_y);
+        }
+
+        // scan all cells of bucket (bx, by) and update the best candidate
+        void scan_bucket(const Game::Position& pos, const int32_t bx, const int32_t by, int32_t& best_distance, Game::Position& best_position) const {
+            const int32_t x0 = bx * BucketSize;
+            const int32_t y0 = by * BucketSize;
+            const int32_t x1 = (x0 + BucketSize) < this->width ? (x0 + BucketSize) : this->width;
+            const int32_t y1 = (y0 + BucketSize) < this->height ? (y0 + BucketSize) : this->height;
+            for (int32_t y = y0; y < y1; ++y) {
+                for (int32_t x = x0; x < x1; ++x) {
+                    if (this->cells[this->cell_index(x, y)] == 0) { continue; }
+                    const int32_t dist = Game::GameBoard::axis_distance(pos.x, x, this->width, this->loop_x) \
+                        + Game::GameBoard::axis_distance(pos.y, y, this->height, this->loop_y);
+                    if (dist < best_distance) {
+                        best_distance = dist;
+                        best_position.set_xy(x, y);
+                    }
+                }
+            }
+        }
+
+    public:
+
+        // game_board has to fit into MaxWidth x MaxHeight (see fits())
+        FruitGrid(const Game::GameBoard& game_board):
+            width(game_board.width), height(game_board.height),
+            buckets_x(0), buckets_y(0),
+            loop_x(game_board.loop_x), loop_y(game_board.loop_y),
+            fruit_count(0)
+        {
+            assert(fits(game_board));
+            this->buckets_x = (this->width + BucketSize - 1) / BucketSize;
+            this->buckets_y = (this->height + BucketSize - 1) / BucketSize;
+            this->clear();
+        }
+
+        static bool fits(const Game::GameBoard& game_board) { return game_board.width <= MaxWidth && game_board.height <= MaxHeight; }
+
+        // remove all fruits
+        void clear() {
+            for (auto& cell : this->cells) { cell = 0; }
+            for (auto& bucket : this->buckets) { bucket = 0; }
+            this->fruit_count = 0;
+        }
+
+        // number of fruits in the grid
+        int32_t size() const { return this->fruit_count; }
+
+        // check if position lies on the board
+        bool contains(const Game::Position& pos) const {
+            return (pos.x >= 0 && pos.x < this->width && pos.y >= 0 && pos.y < this->height);
+        }
+
+        // number of fruits at position
+        int32_t count(const Game::Position& pos) const {
+            return this->contains(pos) ? this->cells[this->cell_index(pos.x, pos.y)] : 0;
+        }
+
+        // add fruit at position
+        bool insert(const Game::Position& pos) {
+            if (!this->contains(pos)) { return false; }
+            uint8_t& cell = this->cells[this->cell_index(pos.x, pos.y)];
+            if (cell == UINT8_MAX) { return false; }
+            cell += 1;
+            this->buckets[this->bucket_index(pos.x, pos.y)] += 1;
+            this->fruit_count += 1;
+            return true;
+        }
+
+        // remove one fruit at position
+        bool remove(const Game::Position& pos) {
+            if (this->count(pos) == 0) { return false; }
+            this->cells[this->cell_index(pos.x, pos.y)] -= 1;
+            this->buckets[this->bucket_index(pos.x, pos.y)] -= 1;
+            this->fruit_count -= 1;
+            return true;
+        }
+
+        /* Find the fruit closest to pos.
+         * first is false if the grid is empty. Fruits with equal distance are resolved deterministically,
+         * the first one found wins.
+         */
+        std::pair<bool, Game::Position> nearest(const Game::Position& pos) const {
+
+            // Start with the bucket which is closest to pos
+            int32_t first_bx = -1;
+            int32_t first_by = -1;
+            int32_t first_distance = INT32_MAX;
+            for (int32_t by = 0; by < this->buckets_y; ++by) {
+                for (int32_t bx = 0; bx < this->buckets_x; ++bx) {
+                    if (this->buckets[(by * max_buckets_x) + bx] == 0) { continue; }
+                    const int32_t dist = this->bucket_distance(pos, bx, by);
+                    if (dist < first_distance) {
+                        first_distance = dist;
+                        first_bx = bx;
+                        first_by = by;
+                    }
+                }
+            }
+            if (first_bx < 0) { return std::pair<bool, Game::Position>(false, pos); }
+
+            int32_t best_distance = INT32_MAX;
+            Game::Position best_position(pos);
+            this->scan_bucket(pos, first_bx, first_by, best_distance, best_position);
+
+            // Only buckets which could contain a closer fruit have to be scanned
+            for (int32_t by = 0; by < this->buckets_y; ++by) {
+                for (int32_t bx = 0; bx < this->buckets_x; ++bx) {
+                    if (this->buckets[(by * max_buckets_x) + bx] == 0) { continue; }
+                    if (bx == first_bx && by == first_by) { continue; }
+                    if (this->bucket_distance(pos, bx, by) >= best_distance) { continue; }
+                    this->scan_bucket(pos, bx, by, best_distance, best_position);
+                }
+            }
+
+            return std::pair<bool, Game::Position>(true, best_position);
+        }
+
+};
+
+// Fruit index for boards up to SNAKE_FRUIT_INDEX_SIZE x SNAKE_FRUIT_INDEX_SIZE LEDs
+typedef FruitGrid<SNAKE_FRUIT_INDEX_SIZE, SNAKE_FRUIT_INDEX_SIZE> FruitIndex;
+
+}; // namespace SnakeGame
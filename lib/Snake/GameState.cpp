@@ -0,0 +1,70 @@
+#include <Arduino.h>
+
+#include "GameState.h"
+
+namespace SnakeGame {
+using namespace Game;
+
+
+GameState::GameState(const GameBoard& Game_board, const int32_t Fruit_count):
+    game_board(Game_board),
+    fruit_count(Fruit_count),
+    snake(board_position(Game_board, Position(Game_board.width/2, Game_board.height/2)), initial_length),
+    fruit_index(Game_board),
+    eaten(0)
+{
+    // the neighbour table converts the cells of the body, the fruit index is sized at compile time (SNAKE_FRUIT_INDEX_SIZE)
+    assert(Game_board.neighbours != nullptr && FruitIndex::fits(Game_board));
+
+    // the body starts with initial_length parts on the same cell, so it can be that much longer than the gameboard
+    this->snake.reserve(Game_board.size() + initial_length);
+    this->fruits.reserve(Fruit_count);
+}
+
+void GameState::reset(Random& rng) {
+
+    this->snake.reset(board_position(this->game_board, Position(this->game_board.width/2, this->game_board.height/2)), initial_length);
+
+    this->effects.clear();
+    this->effects.update_snake(this->snake);
+    this->eaten = 0;
+
+    // Place fruits on gameboard
+    this->fruits.clear();
+    this->fruit_index.clear();
+    for (int32_t i = 0; i < this->fruit_count; ++i) {
+        this->fruits.push_back(create_random_fruit(this->game_board, this->fruits, this->snake, rng));
+        this->fruit_index.insert(this->game_board.position(this->fruits.back().position));
+    }
+}
+
+uint32_t GameState::end_tick(const uint32_t events, const uint32_t base_ms, Random& rng) {
+
+    if (events & Tick_Eat) {
+        this->effects.apply(eaten_fruit_type(events));
+        this->eaten += 1;
+        if (this->eaten % power_up_interval == 0) { this->spawn_power_up(rng); }
+    }
+    this->effects.advance();
+    this->effects.update_snake(this->snake);
+    this->snake.animate_colors();
+    return this->effects.tick_interval(base_ms);
+}
+
+bool GameState::spawn_power_up(Random& rng) {
+
+    // start at a random fruit and take the next normal one
+    const int32_t count = this->fruits.size();
+    if (count == 0) { return false; }
+    const int32_t first = rng(count);
+    for (int32_t i = 0; i < count; ++i) {
+        Fruit& fruit = this->fruits[(first + i) % count];
+        if (fruit.type != Fruit::Normal_Type) { continue; }
+        fruit.type = (Fruit::Type)(Fruit::SpeedBoost_Type + rng(Effects::type_count - 1));
+        fruit.color = Fruit::type_color(fruit.type);
+        return true;
+    }
+    return false;
+}
+
+}; // namespace SnakeGame
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "stdint.h"
+#include "Game.h"
+#include "Snake.h"
+#include "FruitIndex.h"
+#include "Effects.h"
+
+namespace SnakeGame {
+
+/* Everything one round of snake needs: the snake, the fruits, the fruit index and the effects of the power-ups.
+ * The gameboard needs a NeighbourTable and has to fit into the FruitIndex (SNAKE_FRUIT_INDEX_SIZE).
+ * All memory is allocated in the constructor (the body for a snake which covers the whole gameboard, at that length
+ * the snake stops growing and the round is won, see Snake::full()),
+ * reset() starts a new round in O(board) without allocating memory.
+ * Every power_up_interval eaten fruits one of the normal fruits turns into a random power-up.
+ */
+class GameState {
+
+    public:
+
+        static const int32_t initial_length = 5;
+        static const int32_t power_up_interval = 3;
+
+        const Game::GameBoard& game_board;
+        const int32_t fruit_count; // fruits on the gameboard
+        Snake snake;
+        FruitList fruits;
+        FruitIndex fruit_index;
+        Effects effects;
+        int32_t eaten; // fruits in this round
+
+    public:
+
+        GameState(const Game::GameBoard& Game_board, const int32_t Fruit_count = 10);
+
+        // Snake back to the center of the gameboard, new fruits
+        void reset(Game::Random& rng);
+
+        /* After game_tick() with its events: the effect of an eaten power-up is applied, expired effects are removed
+         * and the snake is updated for the next tick. Returns the tick interval for a tick interval of base_ms without effects.
+         */
+        uint32_t end_tick(const uint32_t events, const uint32_t base_ms, Game::Random& rng);
+
+        // Turn a random normal fruit into a random power-up, false if there is none
+        bool spawn_power_up(Game::Random& rng);
+};
+
+}; // namespace SnakeGame
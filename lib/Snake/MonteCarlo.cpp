@@ -0,0 +1,92 @@
+#include <Arduino.h>
+
+#include "MonteCarlo.h"
+#include "esp_timer.h"
+#include <type_traits>
+
+namespace SnakeGame {
+using namespace Game;
+
+static_assert(std::is_trivially_copyable<GameSnapshot>::value, "GameSnapshot has to be cheap to copy");
+
+// Candidate directions (same order as the Direction constants)
+static const int8_t monte_carlo_directions[8][2] = {
+    {0, -1}, {0, 1}, {-1, 0}, {1, 0}, {1, -1}, {-1, -1}, {-1, 1}, {1, 1},
+};
+
+
+int32_t monte_carlo_rollout(GameSnapshot& state, const int32_t candidate, const int32_t depth, Random& rng) {
+
+    int32_t score = 0;
+    uint32_t events = state.step(monte_carlo_directions[candidate][0], monte_carlo_directions[candidate][1]);
+
+    for (int32_t i = 1; !(events & Tick_Game_Over); ++i) {
+
+        // the earlier a fruit is eaten the better, losing the tail costs as much as a fruit
+        if (events & Tick_Eat) { score += 16 * (depth - i + 1); }
+        if (events & Tick_Bite) { score -= 16 * (depth - i + 1); }
+        if (i >= depth) { break; }
+
+        // random direction, but don't run off the gameboard if there is another way
+        int32_t random_candidate = rng(8);
+        for (int32_t tries = 0; tries < 7; ++tries) {
+            if (!state.leaves_board(monte_carlo_directions[random_candidate][0], monte_carlo_directions[random_candidate][1])) { break; }
+            random_candidate = (random_candidate + 1) % 8;
+        }
+        events = state.step(monte_carlo_directions[random_candidate][0], monte_carlo_directions[random_candidate][1]);
+    }
+
+    // leaving the gameboard is worse than anything else
+    if (events & Tick_Game_Over) { return -64 * depth; }
+
+    // end close to a fruit
+    return score - state.nearest_fruit_distance();
+}
+
+Direction get_direction_from_monte_carlo_ai(const GameBoard& game_board, const FruitIndex& fruit_index, const Snake& snake,
+    const uint32_t budget_us, const int32_t depth)
+{
+    const int64_t deadline = esp_timer_get_time() + budget_us;
+    const Direction fallback = get_direction_from_game_ai(game_board, fruit_index, snake);
+
+    GameSnapshot root;
+    if (!root.capture(game_board, fruit_index, snake, esp_random())) { return fallback; }
+    Random rng(esp_random());
+
+    // Rate all candidates round robin until the time is up
+    int64_t score[8] = {0};
+    int32_t rollouts[8] = {0};
+    bool time_left = true;
+    while (time_left) {
+        for (int32_t candidate = 0; candidate < 8 && time_left; ++candidate) {
+
+            // going back isn't possible (it would keep the old direction)
+            if (root.reverses(monte_carlo_directions[candidate][0], monte_carlo_directions[candidate][1])) { continue; }
+
+            GameSnapshot state = root;
+            score[candidate] += monte_carlo_rollout(state, candidate, depth, rng);
+            rollouts[candidate] += 1;
+            time_left = (esp_timer_get_time() < deadline);
+        }
+    }
+
+    // Best average score (compared as fractions), the fallback wins ties
+    int32_t best = -1;
+    for (int32_t candidate = 0; candidate < 8; ++candidate) {
+        if (rollouts[candidate] == 0) { continue; }
+        if (best < 0) { best = candidate; continue; }
+        const int64_t lhs = score[candidate] * rollouts[best];
+        const int64_t rhs = score[best] * rollouts[candidate];
+        const Direction dir(monte_carlo_directions[candidate][0], monte_carlo_directions[candidate][1]);
+        if (lhs > rhs || (lhs == rhs && dir == fallback)) { best = candidate; }
+    }
+    if (best < 0) { return fallback; }
+
+    return Direction(monte_carlo_directions[best][0], monte_carlo_directions[best][1]);
+}
+
+Direction get_direction_from_monte_carlo_ai(const GameBoard& game_board, const FruitIndex& fruit_index, const Snake& snake) {
+    return get_direction_from_monte_carlo_ai(game_board, fruit_index, snake, 1000);
+}
+
+}; // namespace SnakeGame
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "stdint.h"
+#include "Game.h"
+#include "Snake.h"
+#include "FruitIndex.h"
+#include "Snapshot.h"
+
+namespace SnakeGame {
+
+/* Monte-Carlo lookahead AI.
+ * Every candidate direction is rated by short random rollouts (depth ticks) on copies of a GameSnapshot,
+ * round robin until budget_us microseconds are used up. The direction with the best average growth wins,
+ * ties and games which don't fit into a snapshot fall back to get_direction_from_game_ai().
+ */
+Game::Direction get_direction_from_monte_carlo_ai(const Game::GameBoard& game_board, const FruitIndex& fruit_index, const Snake& snake,
+    const uint32_t budget_us, const int32_t depth = 16);
+
+// Monte-Carlo AI with the default budget of 1 ms per tick
+Game::Direction get_direction_from_monte_carlo_ai(const Game::GameBoard& game_board, const FruitIndex& fruit_index, const Snake& snake);
+
+// Play one random rollout from state, starting with direction candidate, returns the score
+int32_t monte_carlo_rollout(GameSnapshot& state, const int32_t candidate, const int32_t depth, Game::Random& rng);
+
+}; // namespace SnakeGame
@@ -0,0 +1,87 @@
+#include <Arduino.h>
+
+#include "Planner.h"
+#include "freertos/task.h"
+
+namespace SnakeGame {
+using namespace Game;
+
+
+void AiPlanner::planner_task(void* args) {
+
+    AiPlanner* planner = (AiPlanner*) args;
+
+    while (true) {
+
+        // wait for the next game state
+        if (xQueueReceive(planner->requests, &planner->incoming, portMAX_DELAY) != pdTRUE) { continue; }
+        if (planner->clear_requested.exchange(false)) { planner->anytime_ai.stats.clear(); }
+
+        const Direction dir = planner->anytime_ai.get_direction(planner->incoming.snapshot, planner->incoming.deadline_us);
+
+        Plan plan;
+        plan.tick = planner->incoming.tick;
+        plan.dir_x = dir.x;
+        plan.dir_y = dir.y;
+        xQueueOverwrite(planner->plans, &plan);
+        xQueueOverwrite(planner->published_stats, &planner->anytime_ai.stats);
+    }
+}
+
+bool AiPlanner::start(const BaseType_t core, const UBaseType_t priority) {
+
+    if (this->task != nullptr) { return true; }
+
+    this->requests = xQueueCreate(1, sizeof(Request));
+    this->plans = xQueueCreate(1, sizeof(Plan));
+    this->published_stats = xQueueCreate(1, sizeof(AnytimeStats));
+    if (this->requests == nullptr || this->plans == nullptr || this->published_stats == nullptr) { return false; }
+
+    return (xTaskCreatePinnedToCore(planner_task, "Planner-Task", 8192, this, priority, &this->task, core) == pdPASS);
+}
+
+bool AiPlanner::request(const uint32_t tick, const int64_t deadline_us, const GameBoard& game_board,
+    const FruitIndex& fruit_index, const Snake& snake, const Direction& dir)
+{
+    if (this->task == nullptr) { return false; }
+    if (!this->outgoing.snapshot.capture(game_board, fruit_index, snake, esp_random())) { return false; }
+
+    this->outgoing.tick = tick;
+    this->outgoing.deadline_us = deadline_us;
+    this->outgoing.snapshot.dir_x = dir.x;
+    this->outgoing.snapshot.dir_y = dir.y;
+    return (xQueueOverwrite(this->requests, &this->outgoing) == pdTRUE);
+}
+
+bool AiPlanner::take(const uint32_t tick, Direction& dir) {
+
+    Plan plan;
+    if (this->task != nullptr && xQueueReceive(this->plans, &plan, 0) == pdTRUE && plan.tick == tick) {
+        dir.set_xy(plan.dir_x, plan.dir_y);
+        this->plans_used += 1;
+        return true;
+    }
+
+    this->plans_stale += 1;
+    return false;
+}
+
+AnytimeStats AiPlanner::stats() const {
+    AnytimeStats stats;
+    if (this->published_stats != nullptr) { xQueuePeek(this->published_stats, &stats, 0); }
+    return stats;
+}
+
+void AiPlanner::print_stats() const {
+    printf("AI-Planner: plans used = %u, stale = %u\n", this->plans_used, this->plans_stale);
+    this->stats().print();
+}
+
+void AiPlanner::clear_stats() {
+    this->plans_used = 0;
+    this->plans_stale = 0;
+    this->clear_requested = true;
+    if (this->published_stats != nullptr) { xQueueReset(this->published_stats); }
+}
+
+}; // namespace SnakeGame
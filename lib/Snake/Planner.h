@@ -0,0 +1,79 @@
+#pragma once
+
+#include "stdint.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "Game.h"
+#include "Snake.h"
+#include "FruitIndex.h"
+#include "Snapshot.h"
+#include "Anytime.h"
+#include <atomic>
+
+namespace SnakeGame {
+
+/* Runs the anytime AI in its own task (on the core which isn't running the game).
+ * After every tick the game task hands over a snapshot of the game with request(), the planner task searches
+ * until the deadline and publishes the direction for the next tick, which the game task picks up with take().
+ * Only the newest request and the newest plan are kept, a plan for another tick counts as stale.
+ * The statistics of the anytime AI belong to the planner task, it publishes a copy after every plan.
+ */
+class AiPlanner {
+
+    public:
+
+        class Request {
+            public:
+                uint32_t tick; // tick the plan is needed for
+                int64_t deadline_us; // esp_timer_get_time() at which the plan is needed
+                GameSnapshot snapshot;
+        };
+
+        class Plan {
+            public:
+                uint32_t tick;
+                int8_t dir_x;
+                int8_t dir_y;
+        };
+
+    protected:
+
+        QueueHandle_t requests;
+        QueueHandle_t plans;
+        QueueHandle_t published_stats; // AnytimeStats after the last plan
+        TaskHandle_t task;
+        Request outgoing; // filled by the game task
+        Request incoming; // used by the planner task
+        AnytimeAi anytime_ai; // only used by the planner task
+        std::atomic<bool> clear_requested;
+
+        static void planner_task(void* args);
+
+    public:
+
+        uint32_t plans_used;
+        uint32_t plans_stale;
+
+    public:
+
+        AiPlanner(): requests(nullptr), plans(nullptr), published_stats(nullptr), task(nullptr), clear_requested(false), plans_used(0), plans_stale(0) {}
+
+        // Create the queues and the planner task
+        bool start(const BaseType_t core = 0, const UBaseType_t priority = 1);
+
+        // Ask for the direction of tick (dir is the direction of the tick which just finished)
+        bool request(const uint32_t tick, const int64_t deadline_us, const Game::GameBoard& game_board,
+            const FruitIndex& fruit_index, const Snake& snake, const Game::Direction& dir);
+
+        // Get the planned direction for tick, false if there is no (up to date) plan
+        bool take(const uint32_t tick, Game::Direction& dir);
+
+        // Statistics of the anytime AI as of the last plan
+        AnytimeStats stats() const;
+
+        void print_stats() const;
+        // the statistics of the anytime AI are cleared by the planner task before its next plan
+        void clear_stats();
+};
+
+}; // namespace SnakeGame
@@ -0,0 +1,114 @@
+#include <Arduino.h>
+
+#include "Renderer.h"
+#include "GameLog.h"
+#include "esp_timer.h"
+
+namespace SnakeGame {
+using namespace Game;
+
+
+Renderer::Renderer(const uint32_t fps):
+    frame_us(1000000 / min_fps), next_frame_us_(0), tick_us(0), fade_us(max_fade_us),
+    vacated(0, 0), has_vacated(false), shown_level(-1), skipped(0), over_budget(0)
+{
+    this->set_fps(fps);
+    this->last = Summary{0, 0, 0, 0, 0, 0};
+}
+
+void Renderer::set_fps(const uint32_t fps) {
+    const uint32_t clamped = (fps < min_fps) ? min_fps : ((fps > max_fps) ? max_fps : fps);
+    this->frame_us = 1000000 / clamped;
+}
+
+void Renderer::tick(const GameBoard& game_board, const Snake& snake, const BoardPosition& old_tail, const int64_t now_us, const int64_t tick_interval_us) {
+
+    this->tick_us = now_us;
+    this->fade_us = (tick_interval_us < max_fade_us) ? tick_interval_us : max_fade_us;
+    if (this->fade_us <= 0) { this->fade_us = 1; }
+
+    // the tail only left its cell if no other part of the body is still on it (the snake didn't grow)
+    this->vacated = game_board.position(old_tail);
+    this->has_vacated = true;
+    for (const auto& body_part : snake.body) {
+        if (body_part == old_tail) { this->has_vacated = false; break; }
+    }
+    this->shown_level = -1;
+}
+
+bool Renderer::begin_frame(const int64_t now_us, const bool force, uint8_t& fade) {
+
+    if (!force && now_us < this->next_frame_us_) { return false; }
+
+    // frames which are overdue are dropped, not caught up
+    this->next_frame_us_ = (force || now_us - this->next_frame_us_ >= this->frame_us) ? (now_us + this->frame_us) : (this->next_frame_us_ + this->frame_us);
+
+    // fade of the move since the last tick (0 - 255), quantized to the steps the LEDs can show at the current brightness
+    const int64_t elapsed_us = now_us - this->tick_us;
+    fade = (elapsed_us >= this->fade_us) ? 255 : (uint8_t)((255 * elapsed_us) / this->fade_us);
+    const int32_t level = ((int32_t) fade * (FastLED.getBrightness() + 1)) >> 8;
+    if (!force && level == this->shown_level) {
+        this->skipped += 1;
+        if (this->render_us.count() + this->skipped >= window_frames) { this->close_window(); }
+        return false;
+    }
+    this->shown_level = level;
+    return true;
+}
+
+void Renderer::draw_frame(LedMatrix& led_matrix, const GameBoard& game_board, const FruitList& fruits, const Snake& snake, const uint8_t fade) {
+
+    draw(led_matrix, game_board, fruits, snake, false);
+
+    // the head turns from the body color into the head color, the cell left by the tail fades out
+    const Position head = game_board.position(snake.head());
+    led_matrix(head.y, head.x) = blend(snake.body_color(0), snake.head_color, fade);
+    if (this->has_vacated) {
+        CRGB& led = led_matrix(this->vacated.y, this->vacated.x);
+        if (led == game_board.board_color) { led = blend(snake.body_color(snake.length() - 1), game_board.board_color, fade); }
+    }
+}
+
+void Renderer::end_frame(const int64_t now_us) {
+
+    const uint32_t frame_time_us = (uint32_t)(esp_timer_get_time() - now_us);
+    this->render_us.record(frame_time_us);
+    if (frame_time_us > this->frame_us) { this->over_budget += 1; }
+    if (this->render_us.count() + this->skipped >= window_frames) { this->close_window(); }
+}
+
+Renderer::Summary Renderer::current() const {
+    Summary summary;
+    summary.frames = this->render_us.count();
+    summary.skipped = this->skipped;
+    summary.mean_us = this->render_us.mean();
+    summary.max_us = this->render_us.max();
+    summary.p99_us = this->render_us.percentile(99);
+    summary.over_budget = this->over_budget;
+    return summary;
+}
+
+void Renderer::close_window() {
+
+    this->last = this->current();
+    GAME_LOG_INFO("render: %u frames shown, %u skipped at %u fps", this->last.frames, this->last.skipped, this->fps());
+    GAME_LOG_INFO("render: avg %u max %u p99 %u us per frame", this->last.mean_us, this->last.max_us, this->last.p99_us);
+    GAME_LOG_INFO("render: budget %u us, %u frames over budget", (uint32_t) this->frame_us, this->last.over_budget);
+    this->render_us.clear();
+    this->skipped = 0;
+    this->over_budget = 0;
+}
+
+void Renderer::print_json() const {
+
+    printf("{\"render\":{\"fps\":%u,\"budget_us\":%u", this->fps(), (uint32_t) this->frame_us);
+    for (int32_t w = 0; w < 2; ++w) {
+        const Summary summary = (w == 0) ? this->last : this->current();
+        const uint32_t usage = (this->frame_us > 0) ? (uint32_t)((100 * (int64_t) summary.mean_us) / this->frame_us) : 0;
+        printf(",\"%s\":{\"frames\":%u,\"skipped\":%u,\"avg_us\":%u,\"max_us\":%u,\"p99_us\":%u,\"over_budget\":%u,\"budget_percent\":%u}",
+            (w == 0) ? "last" : "current", summary.frames, summary.skipped, summary.mean_us, summary.max_us, summary.p99_us, summary.over_budget, usage);
+    }
+    printf("}}\n");
+}
+
+}; // namespace SnakeGame
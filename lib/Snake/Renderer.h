@@ -0,0 +1,108 @@
+#pragma once
+
+#include "stdint.h"
+#include "FastLED.h"
+#include "LedMatrix.h"
+#include "Histogram.h"
+#include "Game.h"
+#include "Snake.h"
+#include "Profiler.h"
+
+namespace SnakeGame {
+
+/* Draws the game at a frame rate of its own between the logic ticks.
+ * The logic calls tick() after every game_tick(), frame() draws the game and interpolates the move since then:
+ * the new head fades in and the cell left by the tail fades out (within max_fade_us, or the tick interval if shorter).
+ * A frame is skipped if the LEDs wouldn't change (the fade is complete, or its step is below the brightness resolution).
+ * The render time of the frames is compared to the frame interval (the budget) and logged every window_frames frames.
+ */
+class Renderer {
+
+    public:
+
+        static const uint32_t min_fps = 60;
+        static const uint32_t max_fps = 100;
+        static const int64_t max_fade_us = 100000;
+        static const uint32_t window_frames = 1024;
+
+        class Summary {
+            public:
+                uint32_t frames; // shown
+                uint32_t skipped;
+                uint32_t mean_us; // draw() and FastLED.show() per frame
+                uint32_t max_us;
+                uint32_t p99_us;
+                uint32_t over_budget; // frames which took longer than the frame interval
+        };
+
+    protected:
+
+        int64_t frame_us; // budget of a frame
+        int64_t next_frame_us_;
+        int64_t tick_us; // time of the last tick
+        int64_t fade_us;
+        Game::Position vacated; // cell left by the tail in the last tick
+        bool has_vacated;
+        int32_t shown_level; // fade level of the last frame, -1 after a tick
+
+        Histogram render_us; // of the current window
+        uint32_t skipped;
+        uint32_t over_budget;
+
+        void close_window();
+
+        // Check if a frame is due and differs from the last one, fade is the progress of the move
+        bool begin_frame(const int64_t now_us, const bool force, uint8_t& fade);
+
+        void draw_frame(LedMatrix& led_matrix, const Game::GameBoard& game_board, const FruitList& fruits, const Snake& snake, const uint8_t fade);
+
+        void end_frame(const int64_t now_us);
+
+    public:
+
+        Summary last; // of the last complete window
+
+    public:
+
+        Renderer(const uint32_t fps = min_fps);
+
+        // Frames per second, clamped to [min_fps, max_fps]
+        void set_fps(const uint32_t fps);
+        uint32_t fps() const { return (uint32_t)(1000000 / this->frame_us); }
+
+        // Time at which the next frame is due
+        int64_t next_frame_us() const { return this->next_frame_us_; }
+
+        /* After a tick at now_us which will last tick_interval_us, old_tail is the tail before the tick.
+         * The next frame is drawn right away.
+         */
+        void tick(const Game::GameBoard& game_board, const Snake& snake, const BoardPosition& old_tail, const int64_t now_us, const int64_t tick_interval_us);
+
+        /* Draw and show the game if a frame is due and it differs from the last one (or always if force is set).
+         * probe (Game::TickProfiler or Game::NoProbe) is marked after drawing and after showing. Returns true if the frame was shown.
+         */
+        template <typename Probe>
+        bool frame(LedMatrix& led_matrix, const Game::GameBoard& game_board, const FruitList& fruits, const Snake& snake, const int64_t now_us, const bool force, Probe& probe) {
+            uint8_t fade;
+            if (!this->begin_frame(now_us, force, fade)) { return false; }
+            this->draw_frame(led_matrix, game_board, fruits, snake, fade);
+            probe.mark(Game::TickProfiler::Phase_Draw);
+            FastLED.show();
+            probe.mark(Game::TickProfiler::Phase_Show);
+            this->end_frame(now_us);
+            return true;
+        }
+
+        bool frame(LedMatrix& led_matrix, const Game::GameBoard& game_board, const FruitList& fruits, const Snake& snake, const int64_t now_us, const bool force = false) {
+            Game::NoProbe probe;
+            return this->frame(led_matrix, game_board, fruits, snake, now_us, force, probe);
+        }
+
+        // Summary of the current (incomplete) window
+        Summary current() const;
+
+        // Print the last complete window and the current one as one line of JSON
+        void print_json() const;
+};
+
+}; // namespace SnakeGame
@@ -2,34 +2,115 @@
 
 #include "Snake.h"
 #include "freertos/task.h"
-#include <map>
+#include "esp_timer.h"
+#include "Planner.h"
+#include "Bitboard.h"
+#include "InputQueue.h"
+#include "Latency.h"
+#include "GameLog.h"
+#include "Feedback.h"
+#include "Telemetry.h"
+#include "GameState.h"
+#include "Renderer.h"
+#include "Scheduler.h"
 #include <algorithm>
 
 namespace SnakeGame {
 using namespace Game;
 
-Fruit create_random_fruit(const GameBoard& game_board, const FruitList& fruits, const Snake& snake) {
-    const Fruit fruit(Position(random(game_board.width), random(game_board.height)), Fruit::Normal_Type, CRGB::Orange /*CRGB::OrangeRed*/);
-    printf("New Fruit at (%d/%d)\n", fruit.position.y, fruit.position.x);
-    return fruit;
+Fruit create_random_fruit(const GameBoard& game_board, const FruitList& fruits, const Snake& snake, Random& rng) {
+    // x first, then y (order of evaluation of function arguments is unspecified)
+    const int32_t x = rng(game_board.width);
+    const int32_t y = rng(game_board.height);
+    return Fruit(board_position(game_board, Position(x, y)), Fruit::Normal_Type, CRGB::Orange);
 }
 
 
+/* Number of cells the snake can reach after its head moved by dir (without biting itself),
+ * -1 if the snake would leave the gameboard or dir is None. free are the cells not blocked by the body after the move.
+ */
+template <typename Board>
+static int32_t reachable_area(const GameBoard& game_board, const Board& free, Board& reach, const Snake& snake, const Direction& dir) {
+
+    if (dir == Direction::None) { return -1; }
+    const Cell next = game_board.next(game_board.cell(snake.head()), dir);
+    if (!next.valid()) { return -1; }
+    return reach.flood_fill(free, game_board.position(next));
+}
+
+/* Keep dir if the snake still has room for its whole body afterwards,
+ * otherwise take the direction which leads into the biggest region.
+ */
+template <typename Board>
+static Direction avoid_enclosed_regions(const GameBoard& game_board, const Snake& snake, const Direction& dir) {
+
+    static const Direction directions[] = {
+        Direction::Up, Direction::Down, Direction::Left, Direction::Right,
+        Direction::UpRight, Direction::UpLeft, Direction::DownLeft, Direction::DownRight,
+    };
+
+    // the tail moves on, so its last cell is free after the move
+    Board free(game_board);
+    Board reach(game_board);
+    free.fill();
+    for (int32_t i = 0; i + 1 < snake.length(); ++i) { free.reset(game_board.position(snake.body[i])); }
+
+    Direction best = dir;
+    int32_t best_area = reachable_area(game_board, free, reach, snake, dir);
+    if (best_area >= snake.length()) { return dir; }
+
+    // we can't go back
+    const Direction last = (snake.length() > 1) ? game_board.direction(game_board.position(snake.body[1]), game_board.position(snake.head())) : Direction::None;
+    for (const auto& candidate : directions) {
+        if (candidate.x + last.x == 0 && candidate.y + last.y == 0) { continue; }
+        const int32_t area = reachable_area(game_board, free, reach, snake, candidate);
+        if (area > best_area) {
+            best = candidate;
+            best_area = area;
+        }
+    }
+    return best;
+}
+
+Direction get_direction_from_game_ai(const GameBoard& game_board, const FruitIndex& fruit_index, const Snake& snake) {
+
+    // head for the closest fruit (the shortest way might loop around the gameboard)
+    const Position head = game_board.position(snake.head());
+    const auto nearest = fruit_index.nearest(head);
+    if (!nearest.first) { return Direction::None; }
+
+    Direction dir = game_board.direction(head, nearest.second);
+    // printf("AI-Direction: Head = %s, fruit = %s, dir = %s\n", head.to_string().c_str(), nearest.second.to_string().c_str(), dir.to_string().c_str());
+
+    // don't run into a region which is too small for the snake
+    if (Bitboard32::fits(game_board)) { dir = avoid_enclosed_regions<Bitboard32>(game_board, snake, dir); }
+    else if (Bitboard64::fits(game_board)) { dir = avoid_enclosed_regions<Bitboard64>(game_board, snake, dir); }
+
+    // the directions above are on the gameboard, game_tick() inverts them again
+    if (game_board.invert_x_movement) { dir.x *= (-1); }
+    if (game_board.invert_y_movement) { dir.y *= (-1); }
+    return dir;
+}
+
 Direction get_direction_from_game_ai(const GameBoard& game_board, const FruitList& fruits, const Snake& snake) {
 
-    std::map<int32_t, Direction> results;
-    // results.reserve(fruit.size());
-    for (auto& fruit : fruits) {
-        const int32_t dist = Position::distance_squared(fruit.position, snake.head());
-        const Direction dir = Position::direction(snake.head(), fruit.position).normalize();
-        results.emplace(dist, dir);
+    FruitIndex fruit_index(game_board);
+    for (const auto& fruit : fruits) {
+        fruit_index.insert(game_board.position(fruit.position));
     }
+    return get_direction_from_game_ai(game_board, fruit_index, snake);
+}
 
-    const auto min_res = std::min_element(results.begin(), results.end(), [](std::map<int32_t, Direction>::value_type a, std::map<int32_t, Direction>::value_type b)-> bool { return (a.first < b.first); });
-    // printf("AI-Direction: Head = %s, dist = %d, dir = %s\n", snake.head().to_string().c_str(), min_res->first, min_res->second.to_string().c_str());
-    return min_res->second;
+
+const CRGBPalette256& gradient_palette() {
+    static const CRGBPalette256 palette(CRGBPalette16(CRGB::Green, CRGB::Teal));
+    return palette;
 }
 
+const CRGBPalette256& rainbow_palette() {
+    static const CRGBPalette256 palette(RainbowColors_p);
+    return palette;
+}
 
 void draw(LedMatrix& led_matrix, const GameBoard& game_board, const FruitList& fruits, const Snake& snake, const bool write_to_leds) {
 
@@ -48,142 +129,205 @@ void draw(LedMatrix& led_matrix, const GameBoard& game_board, const FruitList& f
 
     // draw fruits
     for (const auto& fruit : fruits) {
-        led_matrix(fruit.position.y, fruit.position.x) = fruit.color;
+        const Position pos = game_board.position(fruit.position);
+        led_matrix(pos.y, pos.x) = fruit.color;
     }
 
-    // draw snake body
-    for (const auto& body_part : snake.body) {
-        led_matrix(body_part.y, body_part.x) = snake.body_base_color;
+    // draw snake body, the palette index steps on in 8.24 fixed point from part to part
+    if (snake.body_palette == nullptr) {
+        for (const auto& body_part : snake.body) {
+            const Position pos = game_board.position(body_part);
+            led_matrix(pos.y, pos.x) = snake.body_base_color;
+        }
+    }
+    else {
+        const CRGBPalette256& palette = *snake.body_palette;
+        const uint32_t step = snake.color_step();
+        uint32_t palette_index = (uint32_t) snake.color_offset << 24;
+        for (const auto& body_part : snake.body) {
+            const Position pos = game_board.position(body_part);
+            led_matrix(pos.y, pos.x) = palette[palette_index >> 24];
+            palette_index += step;
+        }
     }
     
     // draw snake head
-    led_matrix(snake.head().y, snake.head().x) = snake.head_color;
+    const Position head = game_board.position(snake.head());
+    led_matrix(head.y, head.x) = snake.head_color;
 
     // push to matrix
     if (write_to_leds) { FastLED.show(); }
 
 }
 
+uint32_t game_tick(const GameBoard& game_board, FruitList& fruits, FruitIndex& fruit_index, Snake& snake, Direction& dir, const Direction& old_dir, Random& rng) {
+    return game_tick(RuntimeRules(game_board), game_board, fruits, fruit_index, snake, dir, old_dir, rng);
+}
+
+// Marks the profiler and the latency trace while the frame of a tick is drawn and shown
+class TickFrameProbe {
+
+    public:
+
+        TickProfiler& profiler;
+        LatencyTrace& trace;
+
+        TickFrameProbe(TickProfiler& Profiler, LatencyTrace& Trace): profiler(Profiler), trace(Trace) {}
+
+        void mark(const int32_t phase) {
+            this->profiler.mark(phase);
+            if (phase == TickProfiler::Phase_Draw) { this->trace.drawn_us = esp_timer_get_time(); }
+            else if (phase == TickProfiler::Phase_Show) { this->trace.shown_us = esp_timer_get_time(); }
+        }
+};
+
 void game_task(void* args) {
 
     // Check task arguments, if nullptr terminate task immediately
     if (args == nullptr) { vTaskDelete(nullptr); }
     
     LedMatrix* led_matrix = (LedMatrix*) args;
-    uint32_t refresh_interval = 125;
+    uint32_t refresh_interval = 125; // of the game logic
+    uint32_t tick_interval = refresh_interval; // of the last tick, with the effects of the power-ups
+    const uint32_t render_fps = 60; // frames between the ticks (60 - 100)
     const int32_t idle_timeout_ms = 10000;
+    const int32_t ai_reserve_ms = 2; // time left after the AI for taking the plan and moving
     int32_t idle_timer_ms = 0;
     Direction dir(1, 0);
     Direction old_dir(0,0);
-    GameBoard game_board (30, 10 , true, true, false, false);
-    Snake snake(Position(game_board.width/2, game_board.height/2));
-    FruitList fruits;
+    typedef Rules<true, true, false, false> GameRules; // loop in x and y, no inverted movement
+    const GameRules rules;
+    static NeighbourStorage<30 * 10> neighbours; // moves of every cell of the gameboard
+    const GameBoard game_board = GameRules::game_board(30, 10).attach(neighbours);
+    static GameState state(game_board); // all memory of a round, allocated once
+    Snake& snake = state.snake;
+    FruitList& fruits = state.fruits;
+    FruitIndex& fruit_index = state.fruit_index;
+    Random rng(esp_random());
+    static AiPlanner planner; // runs the AI on the other core while this task sleeps, its search states take about 8 KB
+    if (!game_log.begin(1 - xPortGetCoreID())) { Serial.println("Log-Task not started, log messages are dropped"); }
+    if (!planner.start(1 - xPortGetCoreID())) { GAME_LOG_WARN("AI-Planner not started, AI runs in the game task"); }
+    uint32_t tick = 0;
+    if (!ps4_input.begin()) { GAME_LOG_WARN("PS4-Input not started, buttons are polled once per tick"); }
+    static LatencyStats latency; // of the buffered turns, send 'l' over serial to print it, 'c' to clear it
+    static ControllerFeedback feedback; // lightbar by length, rumble on fruits and bites
+    static TickProfiler profiler; // time per phase of the tick, send 'p' over serial to print it
+    static Renderer renderer(render_fps); // frames between the ticks, send 'f' over serial to print the frame budget
+    static TickScheduler scheduler; // wakes this task at the ticks and frames, send 's' over serial to print the jitter
+    if (!scheduler.begin()) { GAME_LOG_WARN("Tick timer not created, ticks follow the FreeRTOS tick"); }
+    static HeapTelemetry telemetry; // heap, stack and allocations per tick, send 'h' over serial to print it
+    telemetry.begin();
+    telemetry.seal(); // no heap memory is allocated from here on
 
     while (true) {
 
-        // Place fruits on gameboard
-        for (auto i = 0; i < 10; ++i) {
-            // create new fruit
-            fruits.push_back(create_random_fruit(game_board, fruits, snake));
-        }
+        // New round: snake back to the center, new fruits on gameboard
+        state.reset(rng);
+        dir.set_xy(1, 0);
+        old_dir.set_xy(0, 0);
+        tick_interval = refresh_interval;
+        if (telemetry.allocations_after_setup() > 0) { GAME_LOG_WARN("heap: %u allocations after setup", telemetry.allocations_after_setup()); }
 
         // Draw everything
-        Serial.println("Initilizing Gameboard...");
+        GAME_LOG_INFO("Initilizing Gameboard...");
         draw(*led_matrix, game_board, fruits, snake);
 
         // // wait for game start
         // Serial.println("Press any direction to start");
         // while (get_direction_from_ps4() == Direction::None) { delay(refresh_interval); }
 
-        // Game Loop
-        TickType_t xPreviousWakeTime = xTaskGetTickCount();
+        // Game Loop: a logic tick every refresh_interval, interpolated frames in between
+        scheduler.start(esp_timer_get_time());
         while (true) {
 
-            // get new direction
+            // draw frames until the next tick is due
+            const int64_t now_us = esp_timer_get_time();
+            if (now_us < scheduler.next_tick_us()) {
+                renderer.frame(*led_matrix, game_board, fruits, snake, now_us);
+                scheduler.wait_until(renderer.next_frame_us());
+                continue;
+            }
+
+            // get new direction: the next buttons pressed since the last tick, else what is held right now,
+            // else the AI (it planned during the last sleep, if not use the fast AI)
+            scheduler.tick(now_us);
+            profiler.start();
+            telemetry.start_tick();
             old_dir = dir;
-            dir = get_direction_from_ps4();
+            const Direction current(rules.move_x(old_dir.x), rules.move_y(old_dir.y)); // as the player sees it
+            LatencyTrace trace;
+            const bool traced = ps4_input.next_turn(current, dir, &trace.input_us);
+            if (traced) { trace.resolved_us = esp_timer_get_time(); }
+            else { dir = get_direction_from_ps4(); }
+            profiler.mark(TickProfiler::Phase_Input);
             if (dir == Direction::None) {
-                if (idle_timer_ms <= 0) { dir = get_direction_from_game_ai(game_board, fruits, snake); refresh_interval = 200; }
-                else { idle_timer_ms -= refresh_interval; }
+                if (idle_timer_ms <= 0) {
+                    refresh_interval = 200;
+                    if (!planner.take(tick, dir)) { dir = get_direction_from_game_ai(game_board, fruit_index, snake); }
+                    profiler.mark(TickProfiler::Phase_Ai);
+                }
+                else { idle_timer_ms -= tick_interval; } // time since the last tick
             }
             else { idle_timer_ms = idle_timeout_ms; refresh_interval = 125; }
             if (dir == Direction::None) { dir = old_dir; }
 
 
-            // invert movement if nessesary
-            if (game_board.invert_x_movement) { dir.x *= (-1); }
-            if (game_board.invert_y_movement) { dir.y *= (-1); }
-
-            // we can't go back
-            if (dir + old_dir == Direction(0,0)) { dir = old_dir; }
-
             // move snake
-            snake.move(snake.head() + dir);
-
-            // check if out of gameboard (loop if nesesary)
-            if (snake.head().x < 0 || snake.head().x >= game_board.width) {
-                if (game_board.loop_x) {
-                    Serial.println("x - loopback");
-                    snake.head().x = (snake.head().x + game_board.width) % game_board.width;
-                }
-                else {
-                    Serial.println("x - Out of gameboard");
-                    break;
-                }
+            const BoardPosition old_tail = snake.tail();
+            const uint32_t events = game_tick(rules, game_board, fruits, fruit_index, snake, dir, old_dir, rng, profiler);
+            if (events & Tick_Loop_X) { GAME_LOG_DEBUG("x - loopback (tick %u)", tick); }
+            if (events & Tick_Loop_Y) { GAME_LOG_DEBUG("y - loopback (tick %u)", tick); }
+            if (events & Tick_Game_Over) { GAME_LOG_INFO("Out of gameboard (tick %u, length %d)", tick, snake.length()); break; }
+            if (events & Tick_Bite) { GAME_LOG_INFO("Biting of Tail! (tick %u, length %d)", tick, snake.length()); }
+            if (eaten_fruit_type(events) != Fruit::Normal_Type) { GAME_LOG_INFO("Power-up %d (tick %u)", eaten_fruit_type(events), tick); }
+            if (snake.full()) { GAME_LOG_INFO("Gameboard full, round won! (tick %u, length %d)", tick, snake.length()); break; }
+            tick_interval = state.end_tick(events, refresh_interval, rng); // effects of the power-ups
+            tick += 1;
+            trace.ticked_us = esp_timer_get_time();
+
+            // let the AI plan the next tick until shortly before this task wakes up again
+            if (idle_timer_ms <= 0) {
+                planner.request(tick, scheduler.deadline_us() + (1000 * (int64_t)(tick_interval - ai_reserve_ms)), game_board, fruit_index, snake, dir);
+                profiler.mark(TickProfiler::Phase_Ai);
             }
-            if (snake.head().y < 0 || snake.head().y >= game_board.height) {
-                if (game_board.loop_y) {
-                    Serial.println("y - loopback");
-                    snake.head().y = (snake.head().y + game_board.height) % game_board.height;
-                }
-                else {
-                    Serial.println("y - Out of gameboard");
-                    break;
-                }
-            }
-
-            // Serial.print("Snake Head at pos. ("); 
-            // Serial.print(snake.head().x, DEC);
-            // Serial.print("|");
-            // Serial.print(snake.head().y, DEC);
-            // Serial.println(")");
-
-
-            // check if snake bites itself
-            Serial.println("Bite Check...");
-            const auto bite_check = snake.is_biting_itself();
-            if (snake.body.size() > 1 && bite_check.first) {
-                Serial.println("Biting of Tail!");
-                snake.bite_off_tail(bite_check.second);
-            }
-
-            // check if snake can eat fruits
-            for (auto& fruit : fruits) {
-                if (snake.head() == fruit.position) {
-                    snake.eat(fruit);
-                    // fruits.erase(fruit);
 
-                    // create new fruit
-                    fruit = create_random_fruit(game_board, fruits, snake);
-
-                    // Snake can only eat one fruit at a time
-                    break;
-                }
+            // Draw the first frame of the tick right away
+            const int64_t frame_us = esp_timer_get_time();
+            TickFrameProbe frame_probe(profiler, trace);
+            renderer.tick(game_board, snake, old_tail, frame_us, 1000 * (int64_t) tick_interval);
+            renderer.frame(*led_matrix, game_board, fruits, snake, frame_us, true, frame_probe);
+            if (traced) { latency.record(trace); }
+            feedback.update(events, snake.length(), game_board.size(), trace.shown_us);
+
+            // serial commands
+            if (Serial.available() > 0) {
+                const int command = Serial.read();
+                if (command == 'l') { latency.print_json(); }
+                else if (command == 'c') { latency.clear(); }
+                else if (command == 'p') { profiler.print_json(); }
+                else if (command == 'h') { telemetry.print_json(); }
+                else if (command == 'f') { renderer.print_json(); }
+                else if (command == 's') { scheduler.print_json(); }
             }
+            profiler.end_tick();
+            telemetry.end_tick(trace.shown_us);
 
-
-
-            // Draw everything
-            draw(*led_matrix, game_board, fruits, snake, true);
-
-            // sleep
-            vTaskDelayUntil(&xPreviousWakeTime, pdMS_TO_TICKS(refresh_interval));
+            // next tick tick_interval after the deadline of this one (a changed interval starts from here)
+            scheduler.schedule_next(1000 * (int64_t) tick_interval);
         }
 
 
+        // AI and input statistics of this round
+        planner.print_stats();
+        planner.clear_stats();
+        ps4_input.print_stats();
+        ps4_input.clear_stats();
+        feedback.reset();
+
         // delay after game ended
         while (get_direction_from_ps4() != Direction::None) { delay(refresh_interval); }
         delay (5000);
+        ps4_input.clear();
 
     }
 
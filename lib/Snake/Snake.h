@@ -5,9 +5,27 @@
 #include "Ringbuffer.h"
 #include "LedMatrix.h"
 #include "Game.h"
+#include "FruitIndex.h"
+#include "Profiler.h"
+
+// Store the body and the fruits as 16 bit Cells instead of Positions (a quarter of the memory, the bite check
+// compares one 16 bit index per body part). Needs gameboards with less than 65535 cells, 0 stores Positions.
+#ifndef SNAKE_PACKED_POSITIONS
+#define SNAKE_PACKED_POSITIONS 1
+#endif
 
 namespace SnakeGame {
 
+#if SNAKE_PACKED_POSITIONS
+typedef Game::Cell BoardPosition;
+inline BoardPosition board_position(const Game::GameBoard& game_board, const Game::Position& pos) { return game_board.cell(pos); }
+inline BoardPosition board_position(const Game::GameBoard& game_board, const Game::Cell& cell) { return cell; }
+#else
+typedef Game::Position BoardPosition;
+inline BoardPosition board_position(const Game::GameBoard& game_board, const Game::Position& pos) { return pos; }
+inline BoardPosition board_position(const Game::GameBoard& game_board, const Game::Cell& cell) { return game_board.position(cell); }
+#endif
+
 class Fruit {
 
 
@@ -22,19 +40,19 @@ class Fruit {
         };
 
         enum Color : int32_t {
-            Normal_Color = CRGB::Blue,
-            SpeedBoost_Color = CRGB::Red,
-            SlowDown_Color = CRGB::Green,
+            Normal_Color = CRGB::Orange,
+            SpeedBoost_Color = CRGB::Yellow, // head and body are red and green
+            SlowDown_Color = CRGB::Blue,
             Ghost_Color = CRGB::White,
             Rainbow_Color = CRGB::Violet,
         };
 
     public:
-        Game::Position position;
+        BoardPosition position;
         Type type;
         CRGB color;
 
-    Fruit(const Game::Position& pos, const Type& fruit_type = Normal_Type, const CRGB& Color = CRGB::Blue): position(pos), type(fruit_type), color(Color) {}
+    Fruit(const BoardPosition& pos, const Type& fruit_type = Normal_Type, const CRGB& Color = CRGB::Blue): position(pos), type(fruit_type), color(Color) {}
 
     Fruit(const Fruit& other): position(other.position), type(other.type), color(other.color) {}
 
@@ -46,6 +64,17 @@ class Fruit {
         }
     }
 
+    // Color of the fruits of type
+    static CRGB type_color(const Type fruit_type) {
+        switch (fruit_type) {
+            case SpeedBoost_Type: return CRGB(SpeedBoost_Color);
+            case SlowDown_Type: return CRGB(SlowDown_Color);
+            case Ghost_Type: return CRGB(Ghost_Color);
+            case Rainbow_Type: return CRGB(Rainbow_Color);
+            default: return CRGB(Normal_Color);
+        }
+    }
+
     // Needed to put Fruits in a set (order doesn't matter in this case)
     bool operator<(const Fruit& other) const { return false; }
 };
@@ -58,52 +87,97 @@ class Snake {
 
         // int32_t length;
 
-        Ringbuffer<Game::Position> body;
+        Ringbuffer<BoardPosition> body;
+        int32_t max_length; // the snake doesn't grow beyond (0: no limit), GameState: the whole gameboard, the round is won
+        bool ghost; // passes over its body without biting it off (Ghost power-up)
         CRGB head_color;
-        CRGB body_base_color;
-        uint8_t length_color_modifier;
-        uint8_t time_color_modifier;
+        CRGB body_base_color; // of all body parts if there is no body_palette
+        const CRGBPalette256* body_palette; // colors of the body from head to tail (nullptr: body_base_color)
+        uint8_t length_color_modifier; // palette entries the body spans from head to tail
+        uint8_t time_color_modifier; // palette entries the colors move on per tick
+        uint8_t color_offset; // palette entry of the head
 
     public:
 
-        Snake(const Game::Position initial_pos, const uint32_t initial_length = 5): body(initial_length, initial_pos), head_color(CRGB::Red), body_base_color(CRGB::Green) {}
+        Snake(const BoardPosition initial_pos, const uint32_t initial_length = 5): body(initial_length, initial_pos), max_length(0), ghost(false), head_color(CRGB::Red), body_base_color(CRGB::Green),
+            body_palette(nullptr), length_color_modifier(0), time_color_modifier(0), color_offset(0) {}
+
+        // Allocate the body for Max_length parts, growing up to that length doesn't allocate memory
+        void reserve(const int32_t Max_length) {
+            this->body.reserve(Max_length);
+            this->max_length = Max_length;
+        }
+
+        // Start again with initial_length parts at initial_pos (keeps the allocated body)
+        void reset(const BoardPosition initial_pos, const uint32_t initial_length = 5) {
+            this->body.assign(initial_length, initial_pos);
+            this->ghost = false;
+        }
 
 
-        Game::Position& head() { return this->body.front(); }
-        const Game::Position& head() const { return this->body.front(); }
-        const Game::Position& tail() const { return this->body.back(); }
-        Game::Position& tail() { return this->body.back(); }
+        BoardPosition& head() { return this->body.front(); }
+        const BoardPosition& head() const { return this->body.front(); }
+        const BoardPosition& tail() const { return this->body.back(); }
+        BoardPosition& tail() { return this->body.back(); }
         int32_t length() const { return this->body.size(); }
 
-        void grow() {
+        /* Palette index of the body parts in 8.24 fixed point: the head at color_offset,
+         * every part length_color_modifier / (length - 1) entries further (the tail at color_offset + length_color_modifier).
+         */
+        uint32_t color_step() const {
+            // rounded up, so the tail reaches the last entry (the error stays below one entry)
+            const uint32_t parts = (this->length() > 1) ? (uint32_t)(this->length() - 1) : 0;
+            return (parts > 0) ? ((((uint32_t) this->length_color_modifier << 24) + parts - 1) / parts) : 0;
+        }
+
+        // Color of body part index (0: head)
+        CRGB body_color(const int32_t index) const {
+            if (this->body_palette == nullptr) { return this->body_base_color; }
+            const uint32_t palette_index = ((uint32_t) this->color_offset << 24) + (this->color_step() * (uint32_t) index);
+            return (*this->body_palette)[palette_index >> 24];
+        }
+
+        // Move the colors on by time_color_modifier (once per tick)
+        void animate_colors() { this->color_offset += this->time_color_modifier; }
+
+        // Add a part at the tail, false at max_length (the snake fills the gameboard)
+        bool grow() {
+            if (this->full()) { return false; }
             this->body.insert(this->body.end(), this->body.back());
+            return true;
         }
 
+        bool full() const { return this->max_length > 0 && this->length() >= this->max_length; }
+
+        // Only normal fruits let the snake grow, the power-ups are applied by Effects
         void eat(const Fruit& fruit) {
-            this->grow();
+            if (fruit.type == Fruit::Normal_Type) { this->grow(); }
         }
 
-        int32_t bite_off_tail(const Ringbuffer<Game::Position>::const_iterator& bite_mark) {
+        int32_t bite_off_tail(const Ringbuffer<BoardPosition>::const_iterator& bite_mark) {
             this->body.erase(bite_mark, this->body.end());
             return this->length();
         }
 
-        void move(const Game::Position& new_head_position) {
+        void move(const BoardPosition& new_head_position) {
             this->body.push_front(new_head_position);
         }
 
-        std::pair<bool, Ringbuffer<Game::Position>::const_iterator> is_biting_itself() const {
+        std::pair<bool, Ringbuffer<BoardPosition>::const_iterator> is_biting_itself() const {
+
+            // a ghost passes over its body
+            if (this->ghost) { return std::pair<bool, Ringbuffer<BoardPosition>::const_iterator>(false, this->body.end()); }
 
             // for every body part
             for (auto body_part = this->body.begin()+1; body_part != this->body.end(); ++body_part) {
 
                 // check if position of body_part is the same as the position of the head
                 if (this->head() == *body_part) {
-                    return std::pair<bool, Ringbuffer<Game::Position>::const_iterator>(true, body_part);
+                    return std::pair<bool, Ringbuffer<BoardPosition>::const_iterator>(true, body_part);
                 }
             }
 
-            return std::pair<bool, Ringbuffer<Game::Position>::const_iterator>(false, this->body.end());
+            return std::pair<bool, Ringbuffer<BoardPosition>::const_iterator>(false, this->body.end());
         }
 
     
@@ -114,9 +188,99 @@ class Snake {
 
 
 
+Game::Direction get_direction_from_game_ai(const Game::GameBoard& game_board, const FruitIndex& fruit_index, const Snake& snake);
 Game::Direction get_direction_from_game_ai(const Game::GameBoard& game_board, const FruitList& fruits, const Snake& snake);
 
-Fruit create_random_fruit(const Game::GameBoard& game_board, const FruitList& fruits, const Snake& snake);
+Fruit create_random_fruit(const Game::GameBoard& game_board, const FruitList& fruits, const Snake& snake, Game::Random& rng);
+
+// Events reported by game_tick()
+enum TickEvent : uint32_t {
+    Tick_None = 0,
+    Tick_Loop_X = 1 << 0, // head looped around in x direction
+    Tick_Loop_Y = 1 << 1, // head looped around in y direction
+    Tick_Bite = 1 << 2, // snake bit off its tail
+    Tick_Eat = 1 << 3, // snake ate a fruit (which was replaced by a new one)
+    Tick_Game_Over = 1 << 4, // snake left the gameboard
+    Tick_Fruit_Type_Shift = 8, // Fruit::Type of the eaten fruit (if Tick_Eat) in the bits from here on
+};
+static_assert((uint32_t) Tick_Loop_X == (uint32_t) Game::NeighbourTable::Wrap_X && (uint32_t) Tick_Loop_Y == (uint32_t) Game::NeighbourTable::Wrap_Y, "GameBoard::wraps() gives the loop events");
+
+// Type of the fruit eaten in a tick with events
+inline Fruit::Type eaten_fruit_type(const uint32_t events) { return (Fruit::Type)(events >> Tick_Fruit_Type_Shift); }
+
+/* Advance the game by one step in direction dir (dir is updated by the inversion and no-reverse rules,
+ * None keeps old_dir). game_board needs a NeighbourTable (see GameBoard::attach()).
+ * rules (Game::Rules or Game::RuntimeRules) have to match the flags of game_board (checked by an assert). With Game::Rules
+ * the inversion and the edge check are constants, the bite check and the fruit check still branch on the game.
+ * probe (Game::TickProfiler or Game::NoProbe) is marked after the move, the bite check and the fruit check.
+ */
+template <typename RuleSet, typename Probe>
+uint32_t game_tick(const RuleSet& rules, const Game::GameBoard& game_board, FruitList& fruits, FruitIndex& fruit_index, Snake& snake, Game::Direction& dir, const Game::Direction& old_dir, Game::Random& rng, Probe& probe) {
+
+    uint32_t events = Tick_None;
+    assert(rules.matches(game_board));
+
+    // invert movement if nessesary (and keep both components in [-1, 1]), None keeps the direction of the last tick
+    dir.normalize();
+    dir.set_xy(rules.move_x(dir.x), rules.move_y(dir.y));
+    if (dir == Game::Direction::None) { dir = old_dir; }
+
+    // we can't go back
+    if (dir + old_dir == Game::Direction(0,0)) { dir = old_dir; }
+    assert(dir != Game::Direction::None);
+
+    // next cell from the neighbour table (looping around is already resolved, Cell::None is outside of the gameboard),
+    // a gameboard which loops in both directions has no Cell::None, so the rules drop the check
+    const Game::Cell head = game_board.cell(snake.head());
+    const Game::Cell next = game_board.next(head, dir);
+    if (!(rules.loop_x() && rules.loop_y()) && !next.valid()) { return events | Tick_Game_Over; }
+    events |= game_board.wraps(head, dir);
+
+    // move snake
+    snake.move(board_position(game_board, next));
+    probe.mark(Game::TickProfiler::Phase_Move);
+
+    // check if snake bites itself
+    const auto bite_check = snake.is_biting_itself();
+    if (snake.body.size() > 1 && bite_check.first) {
+        snake.bite_off_tail(bite_check.second);
+        events |= Tick_Bite;
+    }
+    probe.mark(Game::TickProfiler::Phase_Bite);
+
+    // check if snake can eat fruits
+    for (auto& fruit : fruits) {
+        if (snake.head() == fruit.position) {
+            snake.eat(fruit);
+            events |= ((uint32_t) fruit.type << Tick_Fruit_Type_Shift);
+
+            // create new fruit
+            fruit_index.remove(game_board.position(fruit.position));
+            fruit = create_random_fruit(game_board, fruits, snake, rng);
+            fruit_index.insert(game_board.position(fruit.position));
+            events |= Tick_Eat;
+
+            // Snake can only eat one fruit at a time
+            break;
+        }
+    }
+    probe.mark(Game::TickProfiler::Phase_Fruit);
+
+    return events;
+}
+
+template <typename RuleSet>
+uint32_t game_tick(const RuleSet& rules, const Game::GameBoard& game_board, FruitList& fruits, FruitIndex& fruit_index, Snake& snake, Game::Direction& dir, const Game::Direction& old_dir, Game::Random& rng) {
+    Game::NoProbe probe;
+    return game_tick(rules, game_board, fruits, fruit_index, snake, dir, old_dir, rng, probe);
+}
+
+// Same as above with the rules read from game_board
+uint32_t game_tick(const Game::GameBoard& game_board, FruitList& fruits, FruitIndex& fruit_index, Snake& snake, Game::Direction& dir, const Game::Direction& old_dir, Game::Random& rng);
+
+// Palettes of the snake body with 256 entries, expanded once from 16 (a body part costs one lookup)
+const CRGBPalette256& gradient_palette(); // green head to a teal tail
+const CRGBPalette256& rainbow_palette();
 
 void draw(LedMatrix& led_matrix, const Game::GameBoard& game_board, const FruitList& fruits, const Snake& snake, const bool write_to_leds = true);
 
@@ -0,0 +1,207 @@
+#include "SnakeBatch.h"
+
+namespace SnakeGame {
+using namespace Game;
+
+
+SnakeBatch::SnakeBatch(const GameBoard& Game_board, const int32_t Games, const int32_t Fruits, const int32_t Initial_length, const int32_t Max_length):
+    game_board(Game_board),
+    games(Games),
+    fruits(Fruits),
+    initial_length(Initial_length),
+    max_length((Max_length > 0) ? Max_length : (Game_board.width * Game_board.height + Initial_length)),
+    body_capacity(max_length + 1), // the new head before the tail is dropped
+    head_x(Games), head_y(Games), head_cell(Games),
+    dir_x(Games), dir_y(Games),
+    length_(Games), head_slot(Games),
+    alive_(Games), moved(Games), eaten(Games), events_(Games),
+    rng(Games),
+    body_cells(Games * body_capacity),
+    fruit_cells(Games * Fruits), fruit_types(Games * Fruits),
+    input_x(Games), input_y(Games), ghost(Games)
+{}
+
+void SnakeBatch::reset(const uint32_t seed) {
+
+    for (int32_t game = 0; game < this->games; ++game) {
+
+        // same start as in game_task()
+        this->rng[game] = Random(seed + game);
+        this->head_x[game] = this->game_board.width/2;
+        this->head_y[game] = this->game_board.height/2;
+        this->head_cell[game] = this->cell(this->head_x[game], this->head_y[game]);
+        this->dir_x[game] = 1;
+        this->dir_y[game] = 0;
+        this->length_[game] = this->initial_length;
+        this->head_slot[game] = 0;
+        this->alive_[game] = 1;
+        this->events_[game] = Tick_None;
+        this->input_x[game] = 1;
+        this->input_y[game] = 0;
+        this->ghost[game] = 0;
+        for (int32_t i = 0; i < this->initial_length; ++i) {
+            this->body_cells[this->body_index(game, i)] = this->head_cell[game];
+        }
+
+        // same sequence of random numbers as create_random_fruit()
+        for (int32_t i = 0; i < this->fruits; ++i) {
+            const int32_t x = this->rng[game](this->game_board.width);
+            const int32_t y = this->rng[game](this->game_board.height);
+            this->fruit_cells[(i * this->games) + game] = this->cell(x, y);
+            this->fruit_types[(i * this->games) + game] = Fruit::Normal_Type;
+        }
+    }
+}
+
+// Normalize and invert the input, apply the no-reverse rule, move the head and loop around or end the game
+void SnakeBatch::move_kernel() {
+
+    const int32_t width = this->game_board.width;
+    const int32_t height = this->game_board.height;
+    const int32_t invert_x = this->game_board.invert_x_movement ? -1 : 1;
+    const int32_t invert_y = this->game_board.invert_y_movement ? -1 : 1;
+    const int32_t loop_x = this->game_board.loop_x ? 1 : 0;
+    const int32_t loop_y = this->game_board.loop_y ? 1 : 0;
+
+    int32_t* const hx = this->head_x.data();
+    int32_t* const hy = this->head_y.data();
+    int32_t* const hc = this->head_cell.data();
+    int32_t* const dx = this->dir_x.data();
+    int32_t* const dy = this->dir_y.data();
+    int32_t* const alive = this->alive_.data();
+    int32_t* const moved = this->moved.data();
+    uint32_t* const events = this->events_.data();
+    const int32_t* const in_x = this->input_x.data();
+    const int32_t* const in_y = this->input_y.data();
+
+    for (int32_t game = 0; game < this->games; ++game) {
+
+        // None keeps the direction, we can't go back
+        int32_t new_dx = ((in_x[game] > 0) - (in_x[game] < 0)) * invert_x;
+        int32_t new_dy = ((in_y[game] > 0) - (in_y[game] < 0)) * invert_y;
+        const int32_t none = (new_dx == 0) & (new_dy == 0);
+        new_dx = none ? dx[game] : new_dx;
+        new_dy = none ? dy[game] : new_dy;
+        const int32_t reverse = ((new_dx + dx[game]) == 0) & ((new_dy + dy[game]) == 0);
+        new_dx = reverse ? dx[game] : new_dx;
+        new_dy = reverse ? dy[game] : new_dy;
+
+        // move and check if out of gameboard
+        int32_t x = hx[game] + new_dx;
+        int32_t y = hy[game] + new_dy;
+        const int32_t out_x = (x < 0) | (x >= width);
+        const int32_t out_y = (y < 0) | (y >= height);
+        const int32_t dead_x = out_x & (loop_x ^ 1);
+        const int32_t dead_y = out_y & (loop_y ^ 1);
+        const int32_t dead = dead_x | dead_y;
+        x = (x < 0) ? (x + width) : ((x >= width) ? (x - width) : x);
+        y = (y < 0) ? (y + height) : ((y >= height) ? (y - height) : y);
+
+        const uint32_t tick_events = ((out_x & loop_x & (dead ^ 1)) ? Tick_Loop_X : 0)
+            | ((out_y & loop_y & (dead ^ 1)) ? Tick_Loop_Y : 0)
+            | (dead ? Tick_Game_Over : 0);
+
+        // only running games change, finished games stay frozen
+        const int32_t go = alive[game] & (dead ^ 1);
+        events[game] = alive[game] ? tick_events : Tick_None;
+        moved[game] = go;
+        alive[game] = go;
+        hx[game] = go ? x : hx[game];
+        hy[game] = go ? y : hy[game];
+        hc[game] = go ? ((y * width) + x) : hc[game];
+        dx[game] = go ? new_dx : dx[game];
+        dy[game] = go ? new_dy : dy[game];
+    }
+}
+
+// Push the new head into the body ring (drops the tail) and bite off the tail (unless the snake is a ghost)
+void SnakeBatch::body_kernel() {
+
+    const int32_t capacity = this->body_capacity;
+    const int32_t* const moved = this->moved.data();
+    const int32_t* const hc = this->head_cell.data();
+    const int32_t* const ghost = this->ghost.data();
+    int32_t* const head_slot = this->head_slot.data();
+    int32_t* const length = this->length_.data();
+    uint32_t* const events = this->events_.data();
+
+    for (int32_t game = 0; game < this->games; ++game) {
+
+        // games which didn't move keep their ring (their head cell didn't change either)
+        const int32_t slot = moved[game] ? ((head_slot[game] == 0) ? (capacity - 1) : (head_slot[game] - 1)) : head_slot[game];
+        uint16_t* const body = this->body_cells.data() + (game * capacity);
+        head_slot[game] = slot;
+        body[slot] = hc[game];
+
+        // first body part on the head (length if there is none), the games which didn't move and ghosts don't search
+        const int32_t count = (moved[game] & (ghost[game] == 0)) ? length[game] : 1;
+        int32_t bite = count;
+        for (int32_t i = 1, index = slot + 1; i < count; ++i, ++index) {
+            index = (index == capacity) ? 0 : index;
+            bite = ((body[index] == hc[game]) & (bite == count)) ? i : bite;
+        }
+
+        // check if snake bites itself
+        const int32_t bitten = (bite < count);
+        length[game] = bitten ? bite : length[game];
+        events[game] |= bitten ? Tick_Bite : Tick_None;
+    }
+}
+
+// Find the first fruit below the head of every game
+void SnakeBatch::fruit_kernel() {
+
+    int32_t* const eaten = this->eaten.data();
+    const int32_t* const hc = this->head_cell.data();
+    const int32_t* const moved = this->moved.data();
+
+    for (int32_t game = 0; game < this->games; ++game) {
+        eaten[game] = -1;
+    }
+
+    // backwards, so the first fruit in the list wins
+    for (int32_t fruit = this->fruits - 1; fruit >= 0; --fruit) {
+        const int32_t* const fc = this->fruit_cells.data() + (fruit * this->games);
+        for (int32_t game = 0; game < this->games; ++game) {
+            eaten[game] = ((fc[game] == hc[game]) & moved[game]) ? fruit : eaten[game];
+        }
+    }
+}
+
+// Grow the snakes which found a normal fruit and replace the fruit
+void SnakeBatch::eat_kernel() {
+
+    for (int32_t game = 0; game < this->games; ++game) {
+        const int32_t fruit = this->eaten[game];
+        if (fruit < 0) { continue; }
+        const int32_t index = (fruit * this->games) + game;
+
+        // grow (copy of the tail), like Snake::eat()
+        if (this->fruit_types[index] == Fruit::Normal_Type && this->length_[game] < this->max_length) {
+            this->body_cells[this->body_index(game, this->length_[game])] = this->body_cells[this->body_index(game, this->length_[game] - 1)];
+            this->length_[game] += 1;
+        }
+        this->events_[game] |= ((uint32_t) this->fruit_types[index] << Tick_Fruit_Type_Shift) | Tick_Eat;
+
+        // create new fruit (a normal one, like create_random_fruit())
+        const int32_t x = this->rng[game](this->game_board.width);
+        const int32_t y = this->rng[game](this->game_board.height);
+        this->fruit_cells[index] = this->cell(x, y);
+        this->fruit_types[index] = Fruit::Normal_Type;
+    }
+}
+
+int32_t SnakeBatch::step() {
+
+    this->move_kernel();
+    this->body_kernel();
+    this->fruit_kernel();
+    this->eat_kernel();
+
+    int32_t running = 0;
+    for (int32_t game = 0; game < this->games; ++game) { running += this->alive_[game]; }
+    return running;
+}
+
+
+}; // namespace SnakeGame
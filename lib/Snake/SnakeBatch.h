@@ -0,0 +1,95 @@
+#pragma once
+
+#include "stdint.h"
+#include <vector>
+#include "Game.h"
+#include "Snake.h"
+
+namespace SnakeGame {
+
+/* Many independent snake games on the same gameboard, advanced in lockstep.
+ * The state is stored as struct of arrays across all games, so movement, bite and fruit checks run as
+ * branch-reduced scalar loops (selects instead of branches) over contiguous arrays, eating stays a branch per game.
+ * There is no SIMD code, the compiler may vectorize the loops. The rules are the same as
+ * in game_tick() (normalized input, inversion, None keeps the direction, no-reverse, loop or game over,
+ * bite_off_tail unless the snake is a ghost, one fruit per tick, only normal fruits grow the snake up to
+ * max_length, fruits replaced with Random by normal ones), games which are over are frozen.
+ * All memory is allocated in the constructor: about 2 * max_length bytes per game for the body.
+ */
+class SnakeBatch {
+
+    protected:
+
+        Game::GameBoard game_board;
+        int32_t games;
+        int32_t fruits;
+        int32_t initial_length;
+        int32_t max_length; // Snake::max_length
+        int32_t body_capacity;
+
+        // per game
+        std::vector<int32_t> head_x;
+        std::vector<int32_t> head_y;
+        std::vector<int32_t> head_cell;
+        std::vector<int32_t> dir_x; // direction of the last tick
+        std::vector<int32_t> dir_y;
+        std::vector<int32_t> length_;
+        std::vector<int32_t> head_slot; // slot of the head inside the body ring of the game
+        std::vector<int32_t> alive_;
+        std::vector<int32_t> moved; // game advanced in the current tick
+        std::vector<int32_t> eaten; // index of the eaten fruit or -1
+        std::vector<uint32_t> events_;
+        std::vector<Game::Random> rng;
+
+        // per game and body slot (index = game * body_capacity + slot)
+        std::vector<uint16_t> body_cells;
+
+        // per fruit and game (index = fruit * games + game)
+        std::vector<int32_t> fruit_cells;
+        std::vector<int32_t> fruit_types; // Fruit::Type
+
+        int32_t cell(const int32_t x, const int32_t y) const { return (y * this->game_board.width) + x; }
+        Game::Position position(const int32_t cell) const { return Game::Position(cell % this->game_board.width, cell / this->game_board.width); }
+        int32_t body_index(const int32_t game, const int32_t index) const { return (game * this->body_capacity) + ((this->head_slot[game] + index) % this->body_capacity); }
+
+        void move_kernel();
+        void body_kernel();
+        void fruit_kernel();
+        void eat_kernel();
+
+    public:
+
+        // Direction for the next tick, filled by the caller (same meaning as dir for game_tick())
+        std::vector<int32_t> input_x;
+        std::vector<int32_t> input_y;
+
+        // Snake::ghost of the games for the next tick, filled by the caller (0 or 1)
+        std::vector<int32_t> ghost;
+
+    public:
+
+        // Max_length 0: the whole gameboard plus the initial length (like GameState)
+        SnakeBatch(const Game::GameBoard& Game_board, const int32_t Games, const int32_t Fruits = 10, const int32_t Initial_length = 5, const int32_t Max_length = 0);
+
+        // Start all games, game number i is seeded with seed + i (like run_self_play_benchmark())
+        void reset(const uint32_t seed);
+
+        // Advance all running games by one tick, returns the number of games still running
+        int32_t step();
+
+        int32_t size() const { return this->games; }
+        bool alive(const int32_t game) const { return this->alive_[game] != 0; }
+        uint32_t events(const int32_t game) const { return this->events_[game]; }
+        int32_t length(const int32_t game) const { return this->length_[game]; }
+        Game::Position head(const int32_t game) const { return Game::Position(this->head_x[game], this->head_y[game]); }
+        Game::Position body(const int32_t game, const int32_t index) const { return this->position(this->body_cells[this->body_index(game, index)]); }
+        Game::Position fruit(const int32_t game, const int32_t index) const { return this->position(this->fruit_cells[(index * this->games) + game]); }
+        Fruit::Type fruit_type(const int32_t game, const int32_t index) const { return (Fruit::Type) this->fruit_types[(index * this->games) + game]; }
+
+        // Turn fruit index of a game into a power-up (like GameState::spawn_power_up())
+        void set_fruit_type(const int32_t game, const int32_t index, const Fruit::Type type) { this->fruit_types[(index * this->games) + game] = type; }
+        Game::Direction direction(const int32_t game) const { return Game::Direction(this->dir_x[game], this->dir_y[game]); }
+
+};
+
+}; // namespace SnakeGame
@@ -0,0 +1,202 @@
+#pragma once
+
+#include "stdint.h"
+#include "Game.h"
+#include "Snake.h"
+#include "FruitIndex.h"
+
+namespace SnakeGame {
+
+/* Flat, trivially copyable copy of a running game (for gameboards up to MaxCells cells).
+ * Positions are stored as cell indices (x + y * width) and the body as a fixed size ring,
+ * so copying a snapshot is a single memcpy without any heap allocation.
+ * step() follows the same rules as game_tick(), fruits are replaced using the snapshot's own Random.
+ * Moves and positions use the NeighbourTable of the captured gameboard, which has to outlive the snapshot.
+ */
+template <int32_t MaxCells, int32_t MaxFruits>
+class Snapshot {
+
+    public:
+
+        static const int32_t body_capacity = MaxCells + 8;
+        static const int32_t max_fruits = MaxFruits;
+
+        int16_t width;
+        int16_t height;
+        uint8_t loop_x;
+        uint8_t loop_y;
+        uint8_t invert_x;
+        uint8_t invert_y;
+        int8_t dir_x; // direction of the last tick
+        int8_t dir_y;
+        uint8_t alive;
+        uint8_t fruit_count;
+        int16_t length;
+        int16_t head_slot;
+        Game::Random rng;
+        const Game::NeighbourTable* neighbours;
+        uint16_t fruits[MaxFruits];
+        uint16_t body[body_capacity];
+
+    protected:
+
+        int32_t body_slot(const int32_t index) const { return (this->head_slot + index) % body_capacity; }
+
+    public:
+
+        int32_t cell(const int32_t x, const int32_t y) const { return (y * this->width) + x; }
+        int32_t head() const { return this->body[this->head_slot]; }
+        Game::Position position(const int32_t cell) const { return this->neighbours->position(Game::Cell(cell)); }
+        int32_t head_x() const { return this->position(this->head()).x; }
+        int32_t head_y() const { return this->position(this->head()).y; }
+        int32_t at(const int32_t index) const { return this->body[this->body_slot(index)]; }
+
+        // cell after moving the head by (dx, dy) on the gameboard (Cell::None if this leaves it)
+        Game::Cell next(const int32_t dx, const int32_t dy) const {
+            return this->neighbours->next(Game::Cell(this->head()), Game::NeighbourTable::direction_index(dx, dy));
+        }
+
+        // check if the direction (dx, dy) would turn the snake back (step() keeps the last direction then)
+        bool reverses(int32_t dx, int32_t dy) const {
+            if (this->invert_x) { dx = -dx; }
+            if (this->invert_y) { dy = -dy; }
+            return (dx + this->dir_x == 0 && dy + this->dir_y == 0);
+        }
+
+        // check if moving the head by (dx, dy) ends the game
+        bool leaves_board(int32_t dx, int32_t dy) const {
+            if (this->invert_x) { dx = -dx; }
+            if (this->invert_y) { dy = -dy; }
+            if (dx + this->dir_x == 0 && dy + this->dir_y == 0) { dx = this->dir_x; dy = this->dir_y; }
+            return !this->next(dx, dy).valid();
+        }
+
+        // Manhattan distance from the head to the closest fruit (looping around if the gameboard loops)
+        int32_t nearest_fruit_distance() const {
+            int32_t best = INT32_MAX;
+            const Game::Position head = this->position(this->head());
+            for (int32_t i = 0; i < this->fruit_count; ++i) {
+                const Game::Position fruit = this->position(this->fruits[i]);
+                const int32_t dist = Game::GameBoard::axis_distance(head.x, fruit.x, this->width, this->loop_x) \
+                    + Game::GameBoard::axis_distance(head.y, fruit.y, this->height, this->loop_y);
+                if (dist < best) { best = dist; }
+            }
+            return best;
+        }
+
+        // Direction towards the closest fruit (None if there are no fruits)
+        Game::Direction nearest_fruit_direction() const {
+            int32_t best = INT32_MAX;
+            Game::Direction dir(0, 0);
+            const Game::Position head = this->position(this->head());
+            for (int32_t i = 0; i < this->fruit_count; ++i) {
+                const Game::Position fruit = this->position(this->fruits[i]);
+                const int32_t dist = Game::GameBoard::axis_distance(head.x, fruit.x, this->width, this->loop_x) \
+                    + Game::GameBoard::axis_distance(head.y, fruit.y, this->height, this->loop_y);
+                if (dist < best) {
+                    best = dist;
+                    dir.set_xy(Game::GameBoard::axis_step(head.x, fruit.x, this->width, this->loop_x),
+                        Game::GameBoard::axis_step(head.y, fruit.y, this->height, this->loop_y));
+                }
+            }
+            return dir;
+        }
+
+        /* Copy the game into the snapshot, the last direction is taken from the first two body parts.
+         * Returns false if the gameboard, the snake or the number of fruits is too big.
+         */
+        bool capture(const Game::GameBoard& game_board, const FruitIndex& fruit_index, const Snake& snake, const uint32_t seed) {
+
+            if (game_board.size() > (uint32_t) MaxCells || snake.length() > body_capacity) { return false; }
+
+            this->width = game_board.width;
+            this->height = game_board.height;
+            this->loop_x = game_board.loop_x;
+            this->loop_y = game_board.loop_y;
+            this->invert_x = game_board.invert_x_movement;
+            this->invert_y = game_board.invert_y_movement;
+            this->alive = 1;
+            this->rng = Game::Random(seed);
+            this->neighbours = game_board.neighbours;
+
+            this->length = snake.length();
+            this->head_slot = 0;
+            for (int32_t i = 0; i < snake.length(); ++i) {
+                const Game::Position body_part = game_board.position(snake.body[i]);
+                this->body[i] = this->cell(body_part.x, body_part.y);
+            }
+
+            const Game::Direction dir = (snake.length() > 1) ? game_board.direction(game_board.position(snake.body[1]), game_board.position(snake.head())) : Game::Direction::None;
+            this->dir_x = dir.x;
+            this->dir_y = dir.y;
+
+            this->fruit_count = 0;
+            for (int32_t y = 0; y < game_board.height; ++y) {
+                for (int32_t x = 0; x < game_board.width; ++x) {
+                    for (int32_t n = fruit_index.count(Game::Position(x, y)); n > 0; --n) {
+                        if (this->fruit_count >= MaxFruits) { return false; }
+                        this->fruits[this->fruit_count++] = this->cell(x, y);
+                    }
+                }
+            }
+
+            return true;
+        }
+
+        // Advance the game by one tick, returns the TickEvent flags like game_tick()
+        uint32_t step(int32_t dx, int32_t dy) {
+
+            if (!this->alive) { return Tick_Game_Over; }
+            uint32_t events = Tick_None;
+
+            // invert movement if nessesary
+            if (this->invert_x) { dx = -dx; }
+            if (this->invert_y) { dy = -dy; }
+
+            // None keeps the direction, we can't go back
+            if (dx == 0 && dy == 0) { dx = this->dir_x; dy = this->dir_y; }
+            if (dx + this->dir_x == 0 && dy + this->dir_y == 0) { dx = this->dir_x; dy = this->dir_y; }
+            this->dir_x = dx;
+            this->dir_y = dy;
+
+            // move, the neighbour table already resolved looping around and the edges
+            const Game::Cell next = this->next(dx, dy);
+            if (!next.valid()) { this->alive = 0; return events | Tick_Game_Over; }
+            events |= this->neighbours->wraps(Game::Cell(this->head()), dx, dy);
+            const uint16_t head_cell = next.index;
+            this->head_slot = (this->head_slot + body_capacity - 1) % body_capacity;
+            this->body[this->head_slot] = head_cell;
+
+            // check if snake bites itself
+            for (int32_t i = 1; i < this->length; ++i) {
+                if (this->at(i) == head_cell) {
+                    this->length = i;
+                    events |= Tick_Bite;
+                    break;
+                }
+            }
+
+            // check if snake can eat fruits
+            for (int32_t i = 0; i < this->fruit_count; ++i) {
+                if (this->fruits[i] == head_cell) {
+                    if (this->length < body_capacity) {
+                        this->body[this->body_slot(this->length)] = this->at(this->length - 1);
+                        this->length += 1;
+                    }
+                    const int32_t fruit_x = this->rng(this->width);
+                    const int32_t fruit_y = this->rng(this->height);
+                    this->fruits[i] = this->cell(fruit_x, fruit_y);
+                    events |= Tick_Eat;
+                    break;
+                }
+            }
+
+            return events;
+        }
+
+};
+
+// Snapshot for gameboards up to 512 LEDs (e.g. 30x10 or 32x16)
+typedef Snapshot<512, 16> GameSnapshot;
+
+}; // namespace SnakeGame
@@ -9,6 +9,7 @@
 
 #include "freertos/task.h"
 #include "Snake.h"
+#include "Benchmark.h"
 
 // Change the next defines to match your matrix type and size
 #define DATA_PIN            4
@@ -30,6 +31,11 @@ std::array<CRGB, MATRIX_SIZE> leds;
 LedMatrix led_matrix(leds.data(), MATRIX_WIDTH, MATRIX_HEIGHT, MATRIX_WIRING_START, MATRIX_WIRING_PATTERN);
 
 
+// Set to 1 to run the AI self-play benchmark (JSON over serial) before the game starts (pio run -e benchmark)
+#ifndef RUN_SELF_PLAY_BENCHMARK
+#define RUN_SELF_PLAY_BENCHMARK 0
+#endif
+
 // BT-MAC-Address of Smartphone
 #define SMARTPHONE_BT_MAC "84:C7:EA:B1:11:AB"
 
@@ -47,6 +53,10 @@ void setup() {
     Serial.begin(115200); delay(1000);
     Serial.println("Ready.");
 
+    #if RUN_SELF_PLAY_BENCHMARK
+    SnakeGame::run_self_play_benchmarks();
+    #endif
+
     ps4_controller_setup();
     leds_setup();
 
@@ -87,96 +97,100 @@ void ps4_controller_test() {
     // Below has all accessible outputs from the controller
     if(PS4.isConnected()) {
 
-        if ( PS4.data.button.up )
+        ps4_t data;
+        ps4_event_t event;
+        PS4.read(data, &event);
+
+        if ( data.button.up )
             Serial.println("Up Button");
-        if ( PS4.data.button.down )
+        if ( data.button.down )
             Serial.println("Down Button");
-        if ( PS4.data.button.left )
+        if ( data.button.left )
             Serial.println("Left Button");
-        if ( PS4.data.button.right )
+        if ( data.button.right )
             Serial.println("Right Button");
 
-        if ( PS4.data.button.upright )
+        if ( data.button.upright )
             Serial.println("Up Right");
-        if ( PS4.data.button.upleft )
+        if ( data.button.upleft )
             Serial.println("Up Left");
-        if ( PS4.data.button.downleft )
+        if ( data.button.downleft )
             Serial.println("Down Left");
-        if ( PS4.data.button.downright )
+        if ( data.button.downright )
             Serial.println("Down Right");
 
-        if ( PS4.data.button.triangle )
+        if ( data.button.triangle )
         Serial.println("Triangle Button");
-        if ( PS4.data.button.circle )
+        if ( data.button.circle )
         Serial.println("Circle Button");
-        if ( PS4.data.button.cross )
+        if ( data.button.cross )
             Serial.println("Cross Button");
-        if ( PS4.data.button.square )
+        if ( data.button.square )
             Serial.println("Square Button");
 
-        if ( PS4.data.button.l1 )
+        if ( data.button.l1 )
             Serial.println("l1 Button");
-        if ( PS4.data.button.r1 )
+        if ( data.button.r1 )
             Serial.println("r1 Button");
 
-        if ( PS4.data.button.l3 )
+        if ( data.button.l3 )
             Serial.println("l3 Button");
-        if ( PS4.data.button.r3 )
+        if ( data.button.r3 )
             Serial.println("r3 Button");
 
-        if ( PS4.data.button.share )
+        if ( data.button.share )
             Serial.println("Share Button");
-        if ( PS4.data.button.options )
+        if ( data.button.options )
             Serial.println("Options Button");
 
-        if ( PS4.data.button.ps )
+        if ( data.button.ps )
             Serial.println("PS Button");
-        if ( PS4.data.button.touchpad )
+        if ( data.button.touchpad )
             Serial.println("Touch Pad Button");
 
-        if ( PS4.data.button.l2 ) {
+        if ( data.button.l2 ) {
             Serial.print("l2 button at ");
-            Serial.println(PS4.data.analog.button.l2, DEC);
+            Serial.println(data.analog.button.l2, DEC);
         }
-        if ( PS4.data.button.r2 ) {
+        if ( data.button.r2 ) {
             Serial.print("r2 button at ");
-            Serial.println(PS4.data.analog.button.r2, DEC);
+            Serial.println(data.analog.button.r2, DEC);
         }
 
-        if ( PS4.event.analog_move.stick.lx ) {
-            if (abs(PS4.data.analog.stick.lx) >= 100) {
+        if ( event.analog_move.stick.lx ) {
+            if (abs(data.analog.stick.lx) >= 100) {
                 Serial.print("Left Stick x at ");
-                Serial.println(PS4.data.analog.stick.lx, DEC);
+                Serial.println(data.analog.stick.lx, DEC);
             }
         }
-        if ( PS4.event.analog_move.stick.ly ) {
-            if (abs(PS4.data.analog.stick.ly) >= 100) {
+        if ( event.analog_move.stick.ly ) {
+            if (abs(data.analog.stick.ly) >= 100) {
                 Serial.print("Left Stick y at ");
-                Serial.println(PS4.data.analog.stick.ly, DEC);
+                Serial.println(data.analog.stick.ly, DEC);
             }
         }
-        if ( PS4.event.analog_move.stick.rx ) {
-            if (abs(PS4.data.analog.stick.rx) >= 100) {
+        if ( event.analog_move.stick.rx ) {
+            if (abs(data.analog.stick.rx) >= 100) {
                 Serial.print("Right Stick x at ");
-                Serial.println(PS4.data.analog.stick.rx, DEC);
+                Serial.println(data.analog.stick.rx, DEC);
             }
         }
-        if ( PS4.event.analog_move.stick.ry ) {
-            if (abs(PS4.data.analog.stick.ry) >= 100) {
+        if ( event.analog_move.stick.ry ) {
+            if (abs(data.analog.stick.ry) >= 100) {
                 Serial.print("Right Stick y at ");
-                Serial.println(PS4.data.analog.stick.ry, DEC);
+                Serial.println(data.analog.stick.ry, DEC);
             }
         }
 
-        if (PS4.data.status.charging)
+        if (data.status.charging)
             Serial.println("The controller is charging");
-        if (PS4.data.status.audio)
+        if (data.status.audio)
             Serial.println("The controller has headphones attached");
-        if (PS4.data.status.mic)
+        if (data.status.mic)
             Serial.println("The controller has a mic attached");
 
         // Serial.print("Battey = ");
-        // Serial.print(PS4.data.status.battery, DEC);
+        // Serial.print(data.status.battery, DEC);
         // Serial.println(" / 16");
 
         // Serial.println();
@@ -0,0 +1,95 @@
+#include <Arduino.h>
+#include <unity.h>
+
+#include "Game.h"
+#include "Snake.h"
+#include "Benchmark.h"
+
+using namespace Game;
+using namespace SnakeGame;
+
+static const int32_t games = 8;
+static const int32_t max_ticks = 500;
+static const uint32_t seed = 1;
+static NeighbourStorage<30 * 10> neighbours;
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static Direction nearest_fruit_ai(const GameBoard& game_board, const FruitIndex& fruit_index, const Snake& snake, BenchmarkWorkspace& workspace) {
+    return get_direction_from_game_ai(game_board, fruit_index, snake);
+}
+
+static Direction anytime_ai(const GameBoard& game_board, const FruitIndex& fruit_index, const Snake& snake, BenchmarkWorkspace& workspace) {
+    return get_direction_from_anytime_ai(game_board, fruit_index, snake, workspace.anytime_ai);
+}
+
+// Gameboard without loops, like run_self_play_benchmarks()
+static GameBoard benchmark_board() {
+    return GameBoard(30, 10, false, false, false, false).attach(neighbours);
+}
+
+// The fields print_benchmark_json() prints have to add up
+static void check_result(const BenchmarkResult& result, const int32_t Games, const int32_t Max_ticks) {
+    TEST_ASSERT_EQUAL_INT32(Games, result.games);
+    TEST_ASSERT_TRUE(result.ticks >= Games && result.ticks <= (int64_t) Games * Max_ticks);
+    TEST_ASSERT_TRUE(result.game_overs >= 0 && result.game_overs <= Games);
+    TEST_ASSERT_TRUE(result.max_survival > 0 && result.max_survival <= Max_ticks);
+    TEST_ASSERT_TRUE(result.max_survival >= result.mean_survival());
+    TEST_ASSERT_TRUE(result.fruits >= 0 && result.fruits <= result.ticks);
+    TEST_ASSERT_EQUAL_UINT32((uint32_t) result.ticks, result.tick_latency_us.count());
+    TEST_ASSERT_TRUE(result.tick_latency_us.min() <= result.tick_latency_us.max());
+    TEST_ASSERT_TRUE(result.wall_time_us > 0);
+    TEST_ASSERT_TRUE(result.ticks_per_second() > 0.0);
+    // a game which didn't end played all ticks
+    TEST_ASSERT_TRUE(result.ticks >= (int64_t)(Games - result.game_overs) * Max_ticks);
+}
+
+void test_benchmark_nearest_fruit(void) {
+    const GameBoard game_board = benchmark_board();
+    const BenchmarkResult result = run_self_play_benchmark("nearest_fruit", nearest_fruit_ai, game_board, games, max_ticks, seed);
+    check_result(result, games, max_ticks);
+    TEST_ASSERT_EQUAL_STRING("nearest_fruit", result.ai_name);
+    TEST_ASSERT_EQUAL_UINT32(0, result.anytime_stats.calls);
+    print_benchmark_json(game_board, &result, 1);
+}
+
+// Every game is seeded by its number, the totals don't depend on the workers
+void test_benchmark_deterministic(void) {
+    const GameBoard game_board = benchmark_board();
+    const BenchmarkResult one = run_self_play_benchmark("nearest_fruit", nearest_fruit_ai, game_board, games, max_ticks, seed, 1);
+    const BenchmarkResult two = run_self_play_benchmark("nearest_fruit", nearest_fruit_ai, game_board, games, max_ticks, seed, 2);
+    TEST_ASSERT_EQUAL_INT32(one.games, two.games);
+    TEST_ASSERT_TRUE(one.ticks == two.ticks);
+    TEST_ASSERT_TRUE(one.fruits == two.fruits);
+    TEST_ASSERT_EQUAL_INT32(one.game_overs, two.game_overs);
+    TEST_ASSERT_EQUAL_INT32(one.max_survival, two.max_survival);
+}
+
+void test_benchmark_anytime(void) {
+    const GameBoard game_board = benchmark_board();
+    const BenchmarkResult result = run_self_play_benchmark("anytime", anytime_ai, game_board, 2, 100, seed);
+    check_result(result, 2, 100);
+
+    // one search per tick, each ends at one depth
+    const AnytimeStats& stats = result.anytime_stats;
+    TEST_ASSERT_EQUAL_UINT32((uint32_t) result.ticks, stats.calls);
+    uint32_t depths = 0;
+    for (int32_t depth = 0; depth <= AnytimeStats::max_depth; ++depth) { depths += stats.depth_count[depth]; }
+    TEST_ASSERT_EQUAL_UINT32(stats.calls, depths);
+    TEST_ASSERT_TRUE(stats.deadline_hits <= stats.calls);
+    print_benchmark_json(game_board, &result, 1);
+}
+
+void setup() {
+    delay(2000); // wait for the serial monitor
+
+    UNITY_BEGIN();
+    RUN_TEST(test_benchmark_nearest_fruit);
+    RUN_TEST(test_benchmark_deterministic);
+    RUN_TEST(test_benchmark_anytime);
+    UNITY_END();
+}
+
+void loop() {}
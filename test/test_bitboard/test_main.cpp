@@ -0,0 +1,122 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <vector>
+
+#include "Game.h"
+#include "Snake.h"
+#include "Bitboard.h"
+
+using namespace Game;
+using namespace SnakeGame;
+
+static const int32_t boards = 3000;
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+// Cells of free reachable from start, one cell after the other (breadth first)
+template <typename Board>
+static void reference_flood_fill(const GameBoard& game_board, const Board& free, const Position& start, const bool diagonal, std::vector<uint8_t>& reached) {
+
+    reached.assign(game_board.size(), 0);
+    if (!free.test(start)) { return; }
+    std::vector<Position> queue(1, start);
+    reached[game_board.cell(start).index] = 1;
+    for (size_t i = 0; i < queue.size(); ++i) {
+        for (int32_t dy = -1; dy <= 1; ++dy) {
+            for (int32_t dx = -1; dx <= 1; ++dx) {
+                if ((dx == 0 && dy == 0) || (!diagonal && dx != 0 && dy != 0)) { continue; }
+                Position next = queue[i] + Direction(dx, dy);
+                if ((next.x < 0 || next.x >= game_board.width) && !game_board.loop_x) { continue; }
+                if ((next.y < 0 || next.y >= game_board.height) && !game_board.loop_y) { continue; }
+                next.set_xy((next.x + game_board.width) % game_board.width, (next.y + game_board.height) % game_board.height);
+                const Cell cell = game_board.cell(next);
+                if (reached[cell.index] || !free.test(next)) { continue; }
+                reached[cell.index] = 1;
+                queue.push_back(next);
+            }
+        }
+    }
+}
+
+// flood_fill() against the reference on random gameboards with random obstacles
+template <typename Board>
+static void check_flood_fill(const uint32_t seed) {
+
+    Random rng(seed);
+    std::vector<uint8_t> reached;
+    for (int32_t board = 0; board < boards; ++board) {
+
+        const GameBoard game_board(1 + rng(Board::max_width), 1 + rng(Board::max_height), rng(2), rng(2));
+        Board free(game_board);
+        free.fill();
+        const int32_t density = rng(70);
+        for (int32_t y = 0; y < game_board.height; ++y) {
+            for (int32_t x = 0; x < game_board.width; ++x) {
+                if (rng(100) < density) { free.reset(x, y); }
+            }
+        }
+
+        const Position start(rng(game_board.width), rng(game_board.height));
+        const bool diagonal = rng(2);
+        Board reach(game_board);
+        const int32_t count = reach.flood_fill(free, start, diagonal);
+        reference_flood_fill(game_board, free, start, diagonal, reached);
+
+        int32_t reference_count = 0;
+        for (int32_t y = 0; y < game_board.height; ++y) {
+            for (int32_t x = 0; x < game_board.width; ++x) {
+                const bool expected = reached[game_board.cell(Position(x, y)).index];
+                TEST_ASSERT_EQUAL(expected, reach.test(x, y));
+                reference_count += expected;
+            }
+        }
+        TEST_ASSERT_EQUAL_INT32(reference_count, count);
+    }
+}
+
+void test_flood_fill_32(void) { check_flood_fill<Bitboard32>(7); }
+void test_flood_fill_64(void) { check_flood_fill<Bitboard64>(11); }
+
+// the nearest fruit AI avoids regions which are too small for the snake, on a gameboard with walls it rarely dies
+void test_game_ai_survives(void) {
+
+    static NeighbourStorage<30 * 10> neighbours;
+    const GameBoard game_board = GameBoard(30, 10, false, false).attach(neighbours);
+    const int32_t games = 16;
+    const int32_t max_ticks = 2000;
+    int32_t ticks = 0;
+    for (int32_t game = 0; game < games; ++game) {
+        Random rng(1 + game);
+        Direction dir(1, 0);
+        Snake snake(board_position(game_board, Position(game_board.width/2, game_board.height/2)));
+        FruitList fruits;
+        FruitIndex fruit_index(game_board);
+        for (auto i = 0; i < 10; ++i) {
+            fruits.push_back(create_random_fruit(game_board, fruits, snake, rng));
+            fruit_index.insert(game_board.position(fruits.back().position));
+        }
+        for (int32_t tick = 0; tick < max_ticks; ++tick) {
+            const Direction old_dir = dir;
+            dir = get_direction_from_game_ai(game_board, fruit_index, snake);
+            if (dir == Direction::None) { dir = old_dir; }
+            ++ticks;
+            if (game_tick(game_board, fruits, fruit_index, snake, dir, old_dir, rng) & Tick_Game_Over) { break; }
+        }
+    }
+    printf("game AI: mean survival %d of %d ticks\n", ticks / games, max_ticks);
+    TEST_ASSERT_GREATER_THAN(max_ticks / 2, ticks / games);
+}
+
+void setup() {
+    delay(2000); // wait for the serial monitor
+
+    UNITY_BEGIN();
+    RUN_TEST(test_flood_fill_32);
+    RUN_TEST(test_flood_fill_64);
+    RUN_TEST(test_game_ai_survives);
+    UNITY_END();
+}
+
+void loop() {}
@@ -0,0 +1,105 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <vector>
+
+#include "Game.h"
+#include "LedMatrix.h"
+#include "Snake.h"
+#include "esp_timer.h"
+
+using namespace Game;
+using namespace SnakeGame;
+
+static const int32_t width = 64;
+static const int32_t height = 64;
+static const int32_t frames = 100;
+static NeighbourStorage<width * height> neighbours;
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+// Snake along the rows (zigzag) of game_board, one part on every cell
+static Snake board_filling_snake(const GameBoard& game_board) {
+    Snake snake(board_position(game_board, Position(0, 0)), game_board.size());
+    for (int32_t i = 0; i < (int32_t) game_board.size(); ++i) {
+        const int32_t y = i / game_board.width;
+        const int32_t x = (y % 2 == 0) ? (i % game_board.width) : (game_board.width - 1 - (i % game_board.width));
+        snake.move(board_position(game_board, Position(x, y)));
+    }
+    return snake;
+}
+
+// the head starts at the color offset, the tail ends at the entry length_color_modifier further on
+void test_palette_span(void) {
+
+    const GameBoard game_board(30, 10, true, true);
+    for (const int32_t length : {2, 5, 17, 255, 256, 300}) {
+        Snake snake(board_position(game_board, Position(0, 0)), length);
+        snake.body_palette = &gradient_palette();
+        for (const uint8_t span : {1, 64, 255}) {
+            snake.length_color_modifier = span;
+            for (const uint8_t offset : {0, 100, 250}) {
+                snake.color_offset = offset;
+                TEST_ASSERT_TRUE(snake.body_color(0) == gradient_palette()[offset]);
+                TEST_ASSERT_TRUE(snake.body_color(length - 1) == gradient_palette()[(uint8_t)(offset + span)]);
+            }
+        }
+    }
+
+    // without palette the whole body has the base color
+    Snake snake(board_position(game_board, Position(0, 0)), 10);
+    snake.body_palette = nullptr;
+    TEST_ASSERT_TRUE(snake.body_color(0) == snake.body_base_color);
+    TEST_ASSERT_TRUE(snake.body_color(9) == snake.body_base_color);
+}
+
+/* Draw a snake which fills the gameboard frames times with the flat body color, the gradient palette and
+ * the moving rainbow palette: every body part on the LEDs has the color of Snake::body_color(), and the
+ * gradient costs about as much as the flat color (prints the time per frame of all three).
+ */
+void test_draw_body_palette(void) {
+
+    const GameBoard game_board = GameBoard(width, height, false, false, false, false).attach(neighbours);
+    std::vector<CRGB> leds(game_board.size());
+    LedMatrix led_matrix(leds.data(), width, height, LedMatrix::TopLeft, LedMatrix::HorizontalZigZag);
+    const FruitList fruits;
+    Snake snake = board_filling_snake(game_board);
+
+    int64_t time_us[3] = {0, 0, 0};
+    for (int32_t mode = 0; mode < 3; ++mode) {
+        snake.body_palette = (mode == 0) ? nullptr : ((mode == 1) ? &gradient_palette() : &rainbow_palette());
+        snake.length_color_modifier = 255;
+        snake.time_color_modifier = (mode == 2) ? 8 : 0;
+        snake.color_offset = 0;
+
+        const int64_t start = esp_timer_get_time();
+        for (int32_t frame = 0; frame < frames; ++frame) {
+            draw(led_matrix, game_board, fruits, snake, false);
+            snake.animate_colors();
+        }
+        time_us[mode] = esp_timer_get_time() - start;
+
+        // the last frame against the colors of the parts (the head is drawn over)
+        snake.color_offset -= snake.time_color_modifier;
+        for (int32_t i = 1; i < snake.length(); ++i) {
+            const Position pos = game_board.position(snake.body[i]);
+            TEST_ASSERT_TRUE(led_matrix(pos.y, pos.x) == snake.body_color(i));
+        }
+    }
+
+    printf("body palette: %d parts, flat %lld us, gradient %lld us, rainbow %lld us per frame\n", snake.length(),
+        (long long) time_us[0] / frames, (long long) time_us[1] / frames, (long long) time_us[2] / frames);
+    TEST_ASSERT_LESS_OR_EQUAL(2 * time_us[0], time_us[1]);
+}
+
+void setup() {
+    delay(2000); // wait for the serial monitor
+
+    UNITY_BEGIN();
+    RUN_TEST(test_palette_span);
+    RUN_TEST(test_draw_body_palette);
+    UNITY_END();
+}
+
+void loop() {}
@@ -0,0 +1,104 @@
+#include <Arduino.h>
+#include <unity.h>
+
+#include "Game.h"
+#include "Snake.h"
+#include "GameState.h"
+
+using namespace Game;
+using namespace SnakeGame;
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static NeighbourStorage<30 * 10> neighbours;
+
+// GameBoard::position(), next() and wraps() against moving a Position and wrapping it
+static void check_next(const GameBoard& game_board) {
+    for (int32_t y = 0; y < game_board.height; ++y) {
+        for (int32_t x = 0; x < game_board.width; ++x) {
+            TEST_ASSERT_TRUE(game_board.position(game_board.cell(Position(x, y))) == Position(x, y));
+            for (int32_t dy = -1; dy <= 1; ++dy) {
+                for (int32_t dx = -1; dx <= 1; ++dx) {
+                    if (dx == 0 && dy == 0) { continue; }
+                    int32_t next_x = x + dx;
+                    int32_t next_y = y + dy;
+                    const bool outside_x = (next_x < 0 || next_x >= game_board.width);
+                    const bool outside_y = (next_y < 0 || next_y >= game_board.height);
+                    const Cell cell = game_board.cell(Position(x, y));
+                    const Cell next = game_board.next(cell, Direction(dx, dy));
+                    if ((outside_x && !game_board.loop_x) || (outside_y && !game_board.loop_y)) {
+                        TEST_ASSERT_FALSE(next.valid());
+                        continue;
+                    }
+                    next_x = (next_x + game_board.width) % game_board.width;
+                    next_y = (next_y + game_board.height) % game_board.height;
+                    TEST_ASSERT_EQUAL_UINT16(game_board.cell(Position(next_x, next_y)).index, next.index);
+                    const uint32_t wraps = (outside_x ? NeighbourTable::Wrap_X : 0) | (outside_y ? NeighbourTable::Wrap_Y : 0);
+                    TEST_ASSERT_EQUAL_UINT32(wraps, game_board.wraps(cell, Direction(dx, dy)));
+                }
+            }
+        }
+    }
+}
+
+void test_next_looping(void) { check_next(GameBoard(30, 10, true, true).attach(neighbours)); }
+void test_next_walls(void) { check_next(GameBoard(30, 10, false, false).attach(neighbours)); }
+void test_next_loop_x_only(void) { check_next(GameBoard(7, 5, true, false).attach(neighbours)); }
+void test_next_single_row(void) { check_next(GameBoard(9, 1, true, true).attach(neighbours)); }
+void test_next_single_column(void) { check_next(GameBoard(1, 9, false, true).attach(neighbours)); }
+
+// control pad and stick add up to (0, 2), the snake still moves by one cell
+void test_game_tick_clamps_direction(void) {
+    const GameBoard game_board = GameBoard(30, 10, true, true).attach(neighbours);
+    GameState state(game_board, 1);
+    Random rng(7);
+    state.reset(rng);
+
+    const Position head = game_board.position(state.snake.head());
+    Direction dir(0, 2);
+    const Direction old_dir = Direction::Right;
+    game_tick(game_board, state.fruits, state.fruit_index, state.snake, dir, old_dir, rng);
+    TEST_ASSERT_TRUE(dir == Direction::Down);
+    TEST_ASSERT_TRUE(game_board.position(state.snake.head()) == head + Direction::Down);
+
+    Direction diagonal(-3, -2);
+    game_tick(game_board, state.fruits, state.fruit_index, state.snake, diagonal, dir, rng);
+    TEST_ASSERT_TRUE(diagonal == Direction::UpLeft);
+
+    // None keeps the direction of the last tick
+    const Position before = game_board.position(state.snake.head());
+    Direction none(0, 0);
+    game_tick(game_board, state.fruits, state.fruit_index, state.snake, none, diagonal, rng);
+    TEST_ASSERT_TRUE(none == Direction::UpLeft);
+    TEST_ASSERT_TRUE(game_board.position(state.snake.head()) == before + Direction::UpLeft);
+}
+
+// a snake at max_length doesn't grow any more, the gameboard is full
+void test_grow_stops_at_max_length(void) {
+    const GameBoard game_board(4, 4);
+    Snake snake(board_position(game_board, Position(0, 0)), 3);
+    snake.reserve(4);
+    TEST_ASSERT_FALSE(snake.full());
+    TEST_ASSERT_TRUE(snake.grow());
+    TEST_ASSERT_TRUE(snake.full());
+    TEST_ASSERT_FALSE(snake.grow());
+    TEST_ASSERT_EQUAL_INT32(4, snake.length());
+}
+
+void setup() {
+    delay(2000); // wait for the serial monitor
+
+    UNITY_BEGIN();
+    RUN_TEST(test_next_looping);
+    RUN_TEST(test_next_walls);
+    RUN_TEST(test_next_loop_x_only);
+    RUN_TEST(test_next_single_row);
+    RUN_TEST(test_next_single_column);
+    RUN_TEST(test_game_tick_clamps_direction);
+    RUN_TEST(test_grow_stops_at_max_length);
+    UNITY_END();
+}
+
+void loop() {}
@@ -0,0 +1,80 @@
+#include <Arduino.h>
+#include <unity.h>
+
+#include "Game.h"
+#include "Snake.h"
+#include "GameState.h"
+#include "Telemetry.h"
+
+using namespace Game;
+using namespace SnakeGame;
+
+static const int32_t rounds = 16;
+static const int32_t max_ticks = 2000;
+static NeighbourStorage<30 * 10> neighbours;
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+/* Play rounds in one GameState with the nearest fruit AI (reset between the rounds, with power-ups and effects)
+ * and check that nothing allocates heap memory after the GameState was created. Only the operator new calls
+ * of this task are counted, the free heap also changes with what other tasks and the IDF allocate.
+ */
+static void play_rounds_without_heap(const GameBoard& game_board, const uint32_t seed) {
+
+    GameState state(game_board);
+    Random rng(seed);
+
+    // count the allocations of this task (operator new)
+    AllocationCounters::tracked_task = xTaskGetCurrentTaskHandle();
+    const uint32_t allocations = AllocationCounters::task_allocations.load();
+    const uint32_t bytes = AllocationCounters::task_bytes.load();
+
+    int32_t ticks = 0;
+    int32_t eaten = 0;
+    for (int32_t round = 0; round < rounds; ++round) {
+        state.reset(rng);
+        Direction dir(1, 0);
+        Direction old_dir(0, 0);
+        for (int32_t tick = 0; tick < max_ticks; ++tick) {
+            old_dir = dir;
+            dir = get_direction_from_game_ai(game_board, state.fruit_index, state.snake);
+            if (dir == Direction::None) { dir = old_dir; }
+            ++ticks;
+            const uint32_t events = game_tick(game_board, state.fruits, state.fruit_index, state.snake, dir, old_dir, rng);
+            if (events & Tick_Game_Over) { break; }
+            state.end_tick(events, 125, rng);
+        }
+        eaten += state.eaten;
+    }
+
+    const uint32_t heap_allocations = AllocationCounters::task_allocations.load() - allocations;
+    const uint32_t heap_bytes = AllocationCounters::task_bytes.load() - bytes;
+    AllocationCounters::tracked_task = nullptr;
+
+    TEST_ASSERT_GREATER_THAN(rounds, ticks);
+    TEST_ASSERT_GREATER_THAN(GameState::power_up_interval, eaten); // power-ups were spawned and eaten
+    TEST_ASSERT_EQUAL_UINT32(0, heap_allocations);
+    TEST_ASSERT_EQUAL_UINT32(0, heap_bytes);
+}
+
+void test_no_heap_looping(void) { play_rounds_without_heap(GameBoard(30, 10, true, true, false, false).attach(neighbours), 1); }
+void test_no_heap_walls(void) { play_rounds_without_heap(GameBoard(30, 10, false, false, false, false).attach(neighbours), 3); }
+void test_no_heap_inverted(void) { play_rounds_without_heap(GameBoard(16, 16, true, true, true, true).attach(neighbours), 5); }
+
+// the snake reaches the length of the whole gameboard
+void test_no_heap_tiny_board(void) { play_rounds_without_heap(GameBoard(4, 4, true, true, false, false).attach(neighbours), 7); }
+
+void setup() {
+    delay(2000); // wait for the serial monitor
+
+    UNITY_BEGIN();
+    RUN_TEST(test_no_heap_looping);
+    RUN_TEST(test_no_heap_walls);
+    RUN_TEST(test_no_heap_inverted);
+    RUN_TEST(test_no_heap_tiny_board);
+    UNITY_END();
+}
+
+void loop() {}
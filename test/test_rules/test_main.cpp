@@ -0,0 +1,121 @@
+#include <Arduino.h>
+#include <unity.h>
+
+#include "Game.h"
+#include "Snake.h"
+#include "esp_timer.h"
+
+using namespace Game;
+using namespace SnakeGame;
+
+static const int32_t games = 32;
+static const int32_t max_ticks = 2000;
+static const uint32_t seed = 1;
+static NeighbourStorage<30 * 10> neighbours;
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+// Random direction (including None)
+static Direction random_direction(Random& rng) {
+    const int32_t x = rng(3) - 1;
+    const int32_t y = rng(3) - 1;
+    return Direction(x, y);
+}
+
+// One game with random directions and game_tick() with the rules of RuleSet
+template <typename RuleSet>
+class RulesGame {
+
+    public:
+
+        const RuleSet rules;
+        Random rng;
+        Random dir_rng;
+        Direction dir;
+        Snake snake;
+        FruitList fruits;
+        FruitIndex fruit_index;
+
+    public:
+
+        RulesGame(const RuleSet& Rules, const GameBoard& game_board, const int32_t game):
+            rules(Rules), rng(seed + game), dir_rng((seed ^ 0x5A5A5A5A) + game), dir(1, 0),
+            snake(board_position(game_board, Position(game_board.width/2, game_board.height/2))), fruit_index(game_board)
+        {
+            for (auto i = 0; i < 10; ++i) {
+                this->fruits.push_back(create_random_fruit(game_board, this->fruits, this->snake, this->rng));
+                this->fruit_index.insert(game_board.position(this->fruits.back().position));
+            }
+        }
+
+        uint32_t tick(const GameBoard& game_board, int64_t& time_us) {
+            const Direction old_dir = this->dir;
+            this->dir = random_direction(this->dir_rng);
+            if (this->dir == Direction::None) { this->dir = old_dir; }
+            const int64_t start = esp_timer_get_time();
+            const uint32_t events = game_tick(this->rules, game_board, this->fruits, this->fruit_index, this->snake, this->dir, old_dir, this->rng);
+            time_us += esp_timer_get_time() - start;
+            return events;
+        }
+};
+
+/* Play the same games with the rules as template parameters of game_tick() and with the rules read from the
+ * gameboard at runtime: every tick has to give the same events, the same snake and the same fruits.
+ * The time of both is only printed, it isn't a benchmark (the tick includes the fruit replacement and the bite check).
+ */
+template <typename GameRules>
+static void check_rules() {
+
+    const GameBoard game_board = GameRules::game_board(30, 10).attach(neighbours);
+    TEST_ASSERT_TRUE(GameRules::matches(game_board));
+    TEST_ASSERT_TRUE(RuntimeRules(game_board).matches(game_board));
+
+    int64_t ticks = 0;
+    int64_t compile_time_us = 0;
+    int64_t runtime_us = 0;
+    for (int32_t game = 0; game < games; ++game) {
+        RulesGame<GameRules> compile_time(GameRules(), game_board, game);
+        RulesGame<RuntimeRules> runtime(RuntimeRules(game_board), game_board, game);
+        for (int32_t tick = 0; tick < max_ticks; ++tick) {
+            const uint32_t events = compile_time.tick(game_board, compile_time_us);
+            TEST_ASSERT_EQUAL_UINT32(events, runtime.tick(game_board, runtime_us));
+            TEST_ASSERT_TRUE(compile_time.dir == runtime.dir);
+            TEST_ASSERT_TRUE(compile_time.snake.head() == runtime.snake.head());
+            TEST_ASSERT_EQUAL_INT32(compile_time.snake.length(), runtime.snake.length());
+            ++ticks;
+            if (events & Tick_Game_Over) { break; }
+        }
+        for (int32_t i = 0; i < compile_time.snake.length(); ++i) { TEST_ASSERT_TRUE(compile_time.snake.body[i] == runtime.snake.body[i]); }
+        for (int32_t i = 0; i < (int32_t) compile_time.fruits.size(); ++i) { TEST_ASSERT_TRUE(compile_time.fruits[i].position == runtime.fruits[i].position); }
+    }
+    printf("rules: %lld ticks, compile time %lld us, runtime %lld us\n", (long long) ticks, (long long) compile_time_us, (long long) runtime_us);
+}
+
+void test_rules_looping(void) { check_rules<Rules<true, true, false, false>>(); }
+void test_rules_walls(void) { check_rules<Rules<false, false, false, false>>(); }
+void test_rules_inverted_x(void) { check_rules<Rules<true, false, true, false>>(); }
+void test_rules_inverted_y(void) { check_rules<Rules<false, true, false, true>>(); }
+
+void test_rules_match_flags(void) {
+    typedef Rules<true, false, false, true> GameRules;
+    TEST_ASSERT_TRUE(GameRules::matches(GameBoard(30, 10, true, false, false, true)));
+    TEST_ASSERT_FALSE(GameRules::matches(GameBoard(30, 10, true, true, false, true)));
+    TEST_ASSERT_FALSE(GameRules::matches(GameBoard(30, 10, true, false, true, true)));
+    TEST_ASSERT_FALSE(RuntimeRules(GameBoard(30, 10, true, true)).matches(GameBoard(30, 10, false, true)));
+}
+
+void setup() {
+    delay(2000); // wait for the serial monitor
+
+    UNITY_BEGIN();
+    RUN_TEST(test_rules_looping);
+    RUN_TEST(test_rules_walls);
+    RUN_TEST(test_rules_inverted_x);
+    RUN_TEST(test_rules_inverted_y);
+    RUN_TEST(test_rules_match_flags);
+    UNITY_END();
+}
+
+void loop() {}
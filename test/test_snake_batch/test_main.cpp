@@ -0,0 +1,143 @@
+#include <Arduino.h>
+#include <unity.h>
+
+#include "Game.h"
+#include "Snake.h"
+#include "SnakeBatch.h"
+#include "esp_timer.h"
+
+using namespace Game;
+using namespace SnakeGame;
+
+static const int32_t games = 64;
+static const int32_t max_ticks = 2000;
+static const uint32_t seed = 1;
+static NeighbourStorage<30 * 10> neighbours;
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+// Random direction (including None and directions longer than one cell, like control pad and stick together)
+static Direction random_direction(Random& rng) {
+    const int32_t x = rng(5) - 2;
+    const int32_t y = rng(5) - 2;
+    return Direction(x, y);
+}
+
+// One game with game_tick(), started like the games of SnakeBatch
+class ScalarGame {
+
+    public:
+
+        Random rng;
+        Random dir_rng;
+        Direction dir;
+        Snake snake;
+        FruitList fruits;
+        FruitIndex fruit_index;
+        bool game_over;
+
+    public:
+
+        ScalarGame(const GameBoard& game_board, const uint32_t Seed, const uint32_t Input_seed):
+            rng(Seed), dir_rng(Input_seed), dir(1, 0),
+            snake(board_position(game_board, Position(game_board.width/2, game_board.height/2))),
+            fruit_index(game_board), game_over(false)
+        {
+            this->snake.reserve(game_board.size() + 5); // like GameState and the default of SnakeBatch
+            for (auto i = 0; i < 10; ++i) {
+                this->fruits.push_back(create_random_fruit(game_board, this->fruits, this->snake, this->rng));
+                this->fruit_index.insert(game_board.position(this->fruits.back().position));
+            }
+        }
+
+        // same direction as the input of the batch, returns the events
+        uint32_t tick(const GameBoard& game_board, const Direction& input) {
+            const Direction old_dir = this->dir;
+            this->dir = input;
+            const uint32_t events = game_tick(game_board, this->fruits, this->fruit_index, this->snake, this->dir, old_dir, this->rng);
+            this->game_over = (events & Tick_Game_Over);
+            return events;
+        }
+};
+
+/* Play games games for max_ticks ticks with random directions with SnakeBatch and in lockstep with game_tick():
+ * the events of every tick, the body, the direction and the fruits at the end have to match.
+ * Fruits turn into power-ups and the snakes turn into ghosts at random (the same in both).
+ */
+static void check_batch_against_game_tick(const GameBoard& game_board) {
+
+    const uint32_t input_seed = seed ^ 0x5A5A5A5A;
+
+    SnakeBatch batch(game_board, games);
+    batch.reset(seed);
+    std::vector<ScalarGame> scalar;
+    scalar.reserve(games);
+    for (int32_t game = 0; game < games; ++game) { scalar.emplace_back(game_board, seed + game, input_seed + game); }
+
+    int64_t batch_ticks = 0;
+    int64_t batch_time_us = 0;
+    for (int32_t tick = 0; tick < max_ticks; ++tick) {
+
+        for (int32_t game = 0; game < games; ++game) {
+            ScalarGame& scalar_game = scalar[game];
+            const Direction dir = random_direction(scalar_game.dir_rng);
+            batch.input_x[game] = dir.x;
+            batch.input_y[game] = dir.y;
+            if (scalar_game.dir_rng(16) == 0) {
+                const int32_t fruit = scalar_game.dir_rng(scalar_game.fruits.size());
+                const Fruit::Type type = (Fruit::Type)(Fruit::SpeedBoost_Type + scalar_game.dir_rng(4));
+                scalar_game.fruits[fruit].type = type;
+                batch.set_fruit_type(game, fruit, type);
+            }
+            if (scalar_game.dir_rng(32) == 0) {
+                scalar_game.snake.ghost = !scalar_game.snake.ghost;
+                batch.ghost[game] = scalar_game.snake.ghost;
+            }
+        }
+        const int64_t start = esp_timer_get_time();
+        batch.step();
+        batch_time_us += esp_timer_get_time() - start;
+
+        for (int32_t game = 0; game < games; ++game) {
+            ScalarGame& scalar_game = scalar[game];
+            Direction input(batch.input_x[game], batch.input_y[game]);
+            const uint32_t events = scalar_game.game_over ? (uint32_t) Tick_None : scalar_game.tick(game_board, input);
+            TEST_ASSERT_EQUAL_UINT32(events, batch.events(game));
+            if (events != Tick_None || batch.alive(game)) { batch_ticks += 1; }
+        }
+    }
+    printf("batch: %lld ticks in %lld us\n", (long long) batch_ticks, (long long) batch_time_us);
+
+    for (int32_t game = 0; game < games; ++game) {
+        const ScalarGame& scalar_game = scalar[game];
+        TEST_ASSERT_EQUAL(!scalar_game.game_over, batch.alive(game));
+        if (scalar_game.game_over) { continue; }
+        TEST_ASSERT_TRUE(scalar_game.dir == batch.direction(game));
+        TEST_ASSERT_EQUAL_INT32(scalar_game.snake.length(), batch.length(game));
+        for (int32_t i = 0; i < scalar_game.snake.length(); ++i) { TEST_ASSERT_TRUE(game_board.position(scalar_game.snake.body[i]) == batch.body(game, i)); }
+        for (int32_t i = 0; i < (int32_t) scalar_game.fruits.size(); ++i) {
+            TEST_ASSERT_TRUE(game_board.position(scalar_game.fruits[i].position) == batch.fruit(game, i));
+            TEST_ASSERT_EQUAL_INT32(scalar_game.fruits[i].type, batch.fruit_type(game, i));
+        }
+    }
+}
+
+void test_batch_walls(void) { check_batch_against_game_tick(GameBoard(30, 10, false, false, false, false).attach(neighbours)); }
+void test_batch_looping(void) { check_batch_against_game_tick(GameBoard(30, 10, true, true, false, false).attach(neighbours)); }
+void test_batch_inverted(void) { check_batch_against_game_tick(GameBoard(12, 8, true, false, true, true).attach(neighbours)); }
+void test_batch_tiny(void) { check_batch_against_game_tick(GameBoard(4, 3, true, true, false, false).attach(neighbours)); }
+
+void setup() {
+    delay(2000); // wait for the serial monitor
+
+    UNITY_BEGIN();
+    RUN_TEST(test_batch_walls);
+    RUN_TEST(test_batch_looping);
+    RUN_TEST(test_batch_inverted);
+    RUN_TEST(test_batch_tiny);
+    UNITY_END();
+}
+
+void loop() {}
@@ -0,0 +1,128 @@
+#include <Arduino.h>
+#include <unity.h>
+
+#include "Game.h"
+#include "Stick.h"
+#include "esp_timer.h"
+
+using namespace Game;
+using namespace StickOctant;
+
+static const int32_t magnitude_threshold = 100;
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+// The comparison chain the octant table replaced
+static Direction reference_direction(const int32_t analog_x, const int32_t analog_y, const uint32_t threshold) {
+
+    const int32_t magnitude_squared = ((analog_x*analog_x) + (analog_y*analog_y));
+    if (threshold*threshold > (uint32_t) magnitude_squared) { return Direction::None; }
+
+    if (analog_y > 0 && abs(analog_x) <= comp(analog_y)) { return Direction::Up; }
+    else if (analog_y < 0 && abs(analog_x) <= comp(-analog_y)) { return Direction::Down; }
+    else if (analog_x < 0 && abs(analog_y) <= comp(-analog_x)) { return Direction::Left; }
+    else if (analog_x > 0 && abs(analog_y) <= comp(analog_x)) { return Direction::Right; }
+    else if (analog_y > comp(analog_x) && analog_x > comp(analog_y)) { return Direction::UpRight; }
+    else if (analog_y > comp(-analog_x) && (-analog_x) > comp(analog_y)) { return Direction::UpLeft; }
+    else if (analog_y < comp(analog_x) && analog_x < comp(analog_y)) { return Direction::DownLeft; }
+    else if (analog_x > comp(-analog_y) && (-analog_y) > comp(analog_x)) { return Direction::DownRight; }
+    return Direction::None;
+}
+
+static uint8_t table_entry(const int32_t x, const int32_t y) {
+    const int32_t a = (x < 0) ? -x : x;
+    const int32_t b = (y < 0) ? -y : y;
+    return OctantTable::entries[((a < size) ? a : size - 1) + (((b < size) ? b : size - 1) * size)];
+}
+
+static bool in_deadzone_band(const int32_t x, const int32_t y) {
+    const int32_t inner = magnitude_threshold - AnalogStick::deadzone_hysteresis;
+    const int32_t outer = magnitude_threshold + AnalogStick::deadzone_hysteresis;
+    const int32_t magnitude_squared = (x * x) + (y * y);
+    return magnitude_squared >= inner * inner && magnitude_squared < outer * outer;
+}
+
+// all stick positions outside the hysteresis bands give the direction of the comparison chain
+void test_table_matches_comparison_chain(void) {
+
+    int32_t positions = 0;
+    for (int32_t y = -128; y < 128; ++y) {
+        for (int32_t x = -128; x < 128; ++x) {
+            if (in_deadzone_band(x, y) || (table_entry(x, y) & band)) { continue; }
+            AnalogStick stick;
+            TEST_ASSERT_TRUE(stick.update(x, y, magnitude_threshold) == reference_direction(x, y, magnitude_threshold));
+            positions += 1;
+        }
+    }
+    TEST_ASSERT_GREATER_THAN(40000, positions);
+
+    // time of both for all positions
+    int32_t checksum = 0; // keeps the loops from being optimized away
+    const int64_t table_start_us = esp_timer_get_time();
+    for (int32_t y = -128; y < 128; ++y) {
+        for (int32_t x = -128; x < 128; ++x) { checksum += AnalogStick::octant(x, y).x; }
+    }
+    const int64_t chain_start_us = esp_timer_get_time();
+    for (int32_t y = -128; y < 128; ++y) {
+        for (int32_t x = -128; x < 128; ++x) { checksum += reference_direction(x, y, 0).x; }
+    }
+    const int64_t end_us = esp_timer_get_time();
+    printf("stick octants: %d positions, table %lld us, chain %lld us (checksum %d)\n",
+        positions, (long long)(chain_start_us - table_start_us), (long long)(end_us - chain_start_us), checksum);
+}
+
+// inside a band the stick keeps the octant on the other side of the boundary if it pointed there before
+void test_octant_hysteresis(void) {
+
+    int32_t band_positions = 0;
+    for (int32_t y = -128; y < 128; ++y) {
+        for (int32_t x = -128; x < 128; ++x) {
+            if (in_deadzone_band(x, y) || (x * x) + (y * y) < magnitude_threshold * magnitude_threshold) { continue; }
+            const uint8_t entry = table_entry(x, y);
+            if (!(entry & band)) { continue; }
+            band_positions += 1;
+
+            const Direction own = AnalogStick::octant(x, y);
+            AnalogStick fresh;
+            TEST_ASSERT_TRUE(fresh.update(x, y, magnitude_threshold) == own);
+
+            // coming from the neighbouring octant (same quadrant)
+            const uint8_t other_octant = entry >> neighbour_shift;
+            const Direction other(
+                (other_octant != Y) ? ((x < 0) ? -1 : 1) : 0,
+                (other_octant != X) ? ((y < 0) ? 1 : -1) : 0);
+            TEST_ASSERT_TRUE(other != own);
+            AnalogStick stick;
+            stick.last = other;
+            TEST_ASSERT_TRUE(stick.update(x, y, magnitude_threshold) == other);
+        }
+    }
+    TEST_ASSERT_GREATER_THAN(0, band_positions);
+}
+
+// the stick has to be pushed further to leave the deadzone than to stay out of it
+void test_deadzone_hysteresis(void) {
+
+    AnalogStick stick;
+    TEST_ASSERT_TRUE(stick.update(magnitude_threshold, 0, magnitude_threshold) == Direction::None);
+    TEST_ASSERT_TRUE(stick.update(magnitude_threshold + AnalogStick::deadzone_hysteresis, 0, magnitude_threshold) == Direction::Right);
+    TEST_ASSERT_TRUE(stick.update(magnitude_threshold, 0, magnitude_threshold) == Direction::Right);
+    TEST_ASSERT_TRUE(stick.update(magnitude_threshold - AnalogStick::deadzone_hysteresis, 0, magnitude_threshold) == Direction::Right);
+    TEST_ASSERT_TRUE(stick.update(magnitude_threshold - AnalogStick::deadzone_hysteresis - 1, 0, magnitude_threshold) == Direction::None);
+    stick.reset();
+    TEST_ASSERT_TRUE(stick.last == Direction::None);
+}
+
+void setup() {
+    delay(2000); // wait for the serial monitor
+
+    UNITY_BEGIN();
+    RUN_TEST(test_table_matches_comparison_chain);
+    RUN_TEST(test_octant_hysteresis);
+    RUN_TEST(test_deadzone_hysteresis);
+    UNITY_END();
+}
+
+void loop() {}
@@ -0,0 +1,136 @@
+#include <Arduino.h>
+#include <unity.h>
+
+#include "TimerWheel.h"
+
+using namespace Game;
+
+typedef TimerWheel<int32_t, 8, 4> Wheel;
+
+static Wheel wheel;
+static Wheel::Handle handles[8];
+static int32_t expired_values[16];
+static int32_t expired_count;
+
+void setUp(void) {
+    wheel.clear();
+    expired_count = 0;
+    for (auto& handle : handles) { handle = Wheel::None; }
+}
+
+void tearDown(void) {}
+
+static void record(const int32_t value) {
+    if (expired_count < 16) { expired_values[expired_count] = value; }
+    expired_count += 1;
+}
+
+void test_expires_after_delay(void) {
+    const Wheel::Handle handle = wheel.schedule(3, 7);
+    TEST_ASSERT_TRUE(wheel.pending(handle));
+    TEST_ASSERT_EQUAL_UINT32(3, wheel.remaining(handle));
+    TEST_ASSERT_EQUAL_INT32(0, wheel.advance(record));
+    TEST_ASSERT_EQUAL_INT32(0, wheel.advance(record));
+    TEST_ASSERT_EQUAL_INT32(1, wheel.advance(record));
+    TEST_ASSERT_EQUAL_INT32(7, expired_values[0]);
+    TEST_ASSERT_FALSE(wheel.pending(handle));
+    TEST_ASSERT_EQUAL_INT32(0, wheel.size());
+}
+
+void test_timers_beyond_the_slots_wait_for_their_tick(void) {
+    // 4 slots: expiry 2 and 6 share a slot
+    wheel.schedule(6, 6);
+    wheel.schedule(2, 2);
+    for (int32_t tick = 1; tick <= 6; ++tick) {
+        TEST_ASSERT_EQUAL_INT32((tick == 2 || tick == 6) ? 1 : 0, wheel.advance(record));
+    }
+    TEST_ASSERT_EQUAL_INT32(2, expired_values[0]);
+    TEST_ASSERT_EQUAL_INT32(6, expired_values[1]);
+}
+
+void test_cancel_and_stale_handles(void) {
+    const Wheel::Handle handle = wheel.schedule(2, 1);
+    TEST_ASSERT_TRUE(wheel.cancel(handle));
+    TEST_ASSERT_FALSE(wheel.cancel(handle));
+
+    // the entry is reused with another generation, the old handle doesn't match
+    const Wheel::Handle reused = wheel.schedule(2, 2);
+    TEST_ASSERT_EQUAL_HEX32(handle & 0xFFFF, reused & 0xFFFF);
+    TEST_ASSERT_NOT_EQUAL(handle, reused);
+    TEST_ASSERT_FALSE(wheel.pending(handle));
+    TEST_ASSERT_TRUE(wheel.pending(reused));
+
+    // handles from before clear() don't match the timers after it
+    wheel.clear();
+    const Wheel::Handle after_clear = wheel.schedule(2, 3);
+    TEST_ASSERT_FALSE(wheel.pending(reused));
+    TEST_ASSERT_NOT_EQUAL(reused, after_clear);
+}
+
+void test_full_wheel(void) {
+    for (int32_t i = 0; i < Wheel::capacity; ++i) { TEST_ASSERT_NOT_EQUAL(Wheel::None, wheel.schedule(1 + i, i)); }
+    TEST_ASSERT_EQUAL(Wheel::None, wheel.schedule(1, 99));
+    TEST_ASSERT_EQUAL_INT32(Wheel::capacity, wheel.size());
+}
+
+void test_full_slot(void) {
+    // all timers in one slot: half of them expire at tick 2 (oldest first), the others a round later
+    for (int32_t i = 0; i < Wheel::capacity; ++i) { wheel.schedule((i % 2 == 0) ? 2 : 2 + Wheel::slots, i); }
+    TEST_ASSERT_EQUAL_INT32(0, wheel.advance(record));
+    TEST_ASSERT_EQUAL_INT32(Wheel::capacity / 2, wheel.advance(record));
+    for (int32_t i = 0; i < Wheel::capacity / 2; ++i) { TEST_ASSERT_EQUAL_INT32(2 * i, expired_values[i]); }
+    TEST_ASSERT_EQUAL_INT32(Wheel::capacity / 2, wheel.size());
+    for (int32_t tick = 0; tick < Wheel::slots; ++tick) { wheel.advance(record); }
+    TEST_ASSERT_EQUAL_INT32(Wheel::capacity, expired_count);
+    for (int32_t i = 0; i < Wheel::capacity / 2; ++i) { TEST_ASSERT_EQUAL_INT32((2 * i) + 1, expired_values[(Wheel::capacity / 2) + i]); }
+    TEST_ASSERT_EQUAL_INT32(0, wheel.size());
+}
+
+void test_callback_cancels_timer_in_the_same_slot(void) {
+    // three timers expire in the same tick, the first expired one cancels the others
+    for (int32_t i = 0; i < 3; ++i) { handles[i] = wheel.schedule(2, i); }
+    const Wheel::Handle later = wheel.schedule(6, 9); // same slot, later tick
+    wheel.advance(record);
+    const int32_t expired = wheel.advance([](const int32_t value) {
+        record(value);
+        for (int32_t i = 0; i < 3; ++i) { wheel.cancel(handles[i]); }
+    });
+    TEST_ASSERT_EQUAL_INT32(1, expired);
+    TEST_ASSERT_EQUAL_INT32(1, expired_count);
+    TEST_ASSERT_TRUE(wheel.pending(later));
+    TEST_ASSERT_EQUAL_INT32(1, wheel.size());
+
+    // the free list is intact: all other entries can be scheduled
+    for (int32_t i = 1; i < Wheel::capacity; ++i) { TEST_ASSERT_NOT_EQUAL(Wheel::None, wheel.schedule(1, i)); }
+    TEST_ASSERT_EQUAL(Wheel::None, wheel.schedule(1, 0));
+}
+
+void test_callback_schedules_timers(void) {
+    wheel.schedule(1, 0);
+    const int32_t expired = wheel.advance([](const int32_t value) {
+        record(value);
+        // lands in the slot which is being expired, but 4 ticks later
+        wheel.schedule(Wheel::slots, value + 1);
+    });
+    TEST_ASSERT_EQUAL_INT32(1, expired);
+    TEST_ASSERT_EQUAL_INT32(1, wheel.size());
+    for (int32_t tick = 0; tick < Wheel::slots; ++tick) { wheel.advance(record); }
+    TEST_ASSERT_EQUAL_INT32(2, expired_count);
+    TEST_ASSERT_EQUAL_INT32(1, expired_values[1]);
+}
+
+void setup() {
+    delay(2000); // wait for the serial monitor
+
+    UNITY_BEGIN();
+    RUN_TEST(test_expires_after_delay);
+    RUN_TEST(test_timers_beyond_the_slots_wait_for_their_tick);
+    RUN_TEST(test_cancel_and_stale_handles);
+    RUN_TEST(test_full_wheel);
+    RUN_TEST(test_full_slot);
+    RUN_TEST(test_callback_cancels_timer_in_the_same_slot);
+    RUN_TEST(test_callback_schedules_timers);
+    UNITY_END();
+}
+
+void loop() {}